@@ -24,21 +24,33 @@ combat_module::combat_module(flecs::world &world) {
         }
       });
 
-  // Damage system
-  world.observer<cSensor>().event<eTouchBegin>().each(
-      [](flecs::iter &it, size_t i, cSensor sensor) {
-        auto collision = it.param<eTouchBegin>();
-        if (auto weapon = collision->sensor.try_get<cWeapon>()) {
+  // Damage system, over every sensor touch of the frame at once
+  world.system<const sPhysicsEvents>("Weapon Hits")
+      .each([](flecs::iter &it, size_t, const sPhysicsEvents &events) {
+        auto world = it.world();
+        auto &touches = events.touch_begin;
+        for (size_t n = 0; n < touches.size(); n++) {
+          if (!touches.first[n] || !touches.second[n])
+            continue;
+
+          auto sensor = world.get_alive(touches.first[n]);
+          auto visitor = world.get_alive(touches.second[n]);
+          if (!sensor.is_valid() || !visitor.is_valid())
+            continue;
+
+          auto weapon = sensor.try_get<cWeapon>();
+          if (!weapon)
+            continue;
+
           // Deal the damage
-          if (auto target_health = collision->visitor.try_get<cHealth>()) {
+          if (visitor.has<cHealth>()) {
             emit_event<eDealDamage, cHealth>(
-                collision->visitor,
-                eDealDamage{.info = {.dealer = collision->sensor,
-                                     .damage = weapon->damage}});
+                visitor, eDealDamage{.info = {.dealer = sensor,
+                                              .damage = weapon->damage}});
           }
 
           // Invert root rotation
-          auto root = collision->sensor.target<rPhysicsRoot>();
+          auto root = sensor.target<rPhysicsRoot>();
           if (root.is_valid()) {
             if (auto rotation = root.try_get_mut<cConstRotation>()) {
               rotation->degrees = -rotation->degrees;
@@ -1,6 +1,9 @@
 #include "debug_module.hpp"
 
+#include "../luxlib.hpp"
 #include "../modules/input_module.hpp"
+#include "../modules/physics_module.hpp"
+#include "../modules/transform_module.hpp"
 #include "imgui.h"
 
 debug_module::debug_module(flecs::world &world) {
@@ -29,4 +32,30 @@ debug_module::debug_module(flecs::world &world) {
 
         ImGui::End();
       });
+
+  world.system("Debug Textures").run([](flecs::iter &it) {
+    auto stats = Luxlib::instance().render_server.get_texture_stats();
+    ImGui::Begin("Textures");
+    ImGui::Text("Live: %u", stats.live_textures);
+    ImGui::Text("Hits: %llu", (unsigned long long)stats.hits);
+    ImGui::Text("Misses: %llu", (unsigned long long)stats.misses);
+    ImGui::Text("Texture memory: %.2f MB", stats.texture_bytes / 1048576.0);
+    ImGui::Text("Resident memory: %.2f MB", stats.resident_bytes / 1048576.0);
+    ImGui::End();
+  });
+
+  world.system<const sTransformStats>("Debug Transforms")
+      .each([](const sTransformStats &stats) {
+        ImGui::Begin("Transforms");
+        ImGui::Text("Updated: %u / %u", stats.updated, stats.total);
+        ImGui::End();
+      });
+
+  world.system<const sPhysicsTime>("Debug Physics Time")
+      .each([](const sPhysicsTime &time) {
+        ImGui::Begin("Physics");
+        ImGui::Text("Alpha: %.2f", time.alpha);
+        ImGui::Text("Dropped steps: %u", time.dropped_steps);
+        ImGui::End();
+      });
 }
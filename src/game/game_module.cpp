@@ -8,6 +8,7 @@
 #include "../modules/transform_module.hpp"
 #include "debug_module.hpp"
 #include "flecs/addons/cpp/mixins/script/decl.hpp"
+#include "spdlog/spdlog.h"
 #include <random>
 
 static glm::vec2 viewport_to_world(glm::vec2 viewport_pos, glm::vec2 size) {
@@ -37,15 +38,17 @@ game_module::game_module(flecs::world &world) {
 
   world.system<cPhysicsBody>("Clamp characters speed")
       .with<cCharacter>()
-      .each([](cPhysicsBody &body) {
+      .multi_threaded()
+      .each([](flecs::iter &it, size_t, cPhysicsBody &body) {
         const auto SPEED_LIMIT = 250.0f;
         auto b2velocity = b2Body_GetLinearVelocity(body.id);
         auto velocity = glm::vec2{b2velocity.x, b2velocity.y};
         auto speed = glm::length(velocity);
         if (speed > SPEED_LIMIT) {
           auto limited_velocity = glm::normalize(velocity) * SPEED_LIMIT;
-          b2Body_SetLinearVelocity(body.id,
-                                   {limited_velocity.x, limited_velocity.y});
+          auto stage = it.world().get_stage_id();
+          physics_module::get_commands(stage).set_linear_velocity(
+              body.id, limited_velocity);
         }
       });
 
@@ -66,8 +69,8 @@ game_module::game_module(flecs::world &world) {
             }
           } else {
             drag.end = mouse_world;
-            Luxlib::instance().render_server.draw_line(drag.start, drag.end,
-                                                       WHITE);
+            Luxlib::instance().render_server.get_draw_list().draw_line(
+                drag.start, drag.end, WHITE);
           }
         } else {
           if (drag.dragging) {
@@ -80,8 +83,12 @@ game_module::game_module(flecs::world &world) {
       });
 
   world.system<const cPhysicsBody, const cConstRotation>("Constant rotation")
-      .each([](const cPhysicsBody &body, const cConstRotation &rotation) {
-        b2Body_SetAngularVelocity(body.id, glm::radians(rotation.degrees));
+      .multi_threaded()
+      .each([](flecs::iter &it, size_t, const cPhysicsBody &body,
+               const cConstRotation &rotation) {
+        auto stage = it.world().get_stage_id();
+        physics_module::get_commands(stage).set_angular_velocity(
+            body.id, glm::radians(rotation.degrees));
       });
 
   world.system<const rSmoothFollow, cPosition2>("Smooth Follow")
@@ -122,6 +129,7 @@ game_module::game_module(flecs::world &world) {
 
   world.system<cLabel>("Update Health Text")
       .with<cHealthUI>()
+      .multi_threaded()
       .each([](flecs::entity e, cLabel &label) {
         auto parent = e.parent();
         if (!parent.is_valid())
@@ -165,10 +173,21 @@ game_module::game_module(flecs::world &world) {
   world.import <combat_module>();
   world.import <debug_module>();
 
-  auto main_script = world.script("main script")
-                         .filename("./assets/game.flecs")
-                         .run()
-                         .add<cGameplayScript>();
+  // flecs parses from a null-terminated string, so this is the one copy
+  const char *script_path = "assets/game.flecs";
+  auto script_file = Luxlib::instance().vfs.open(script_path);
+  if (script_file.is_valid()) {
+    auto script_bytes = script_file.data();
+    std::string script_code((const char *)script_bytes.data(),
+                            script_bytes.size());
+    world.script("main script")
+        .filename(script_path)
+        .code(script_code.c_str())
+        .run()
+        .add<cGameplayScript>();
+  } else {
+    spdlog::error("Could not open scene script {}", script_path);
+  }
 
   // Demo on how to unload a scene
   world.system<sInputState>("scene test")
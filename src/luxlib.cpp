@@ -13,21 +13,8 @@
 #include "sokol_imgui.h"
 #include "sokol_time.h"
 #include "spdlog/spdlog.h"
-
-GpuTexture load_rgba8_image(std::string path) {
-  int width, height, channels;
-  stbi_uc *pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
-  sg_image_desc image_desc = {
-      .width = width,
-      .height = height,
-      .pixel_format = SG_PIXELFORMAT_RGBA8,
-      .data = {.mip_levels = {
-                   {.ptr = pixels, .size = (size_t)(width * height * 4)}}}};
-  sg_image image = sg_make_image(image_desc);
-  sg_view view = sg_alloc_view();
-  sg_init_view(view, {.texture = {.image = image}});
-  return {.view = view, .image = image};
-}
+#include <algorithm>
+#include <thread>
 
 void Luxlib::init() {
   spdlog::info("starting luxlib...");
@@ -56,7 +43,23 @@ void Luxlib::init() {
   simgui_setup(&simgui_desc);
   ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
-  render_server.init();
+  // Without a pack everything is read from loose files
+  if (!vfs.mount("assets.pack"))
+    spdlog::info("vfs: no assets.pack, using loose files");
+
+  render_server.init(vfs);
+
+  // The physics solver and the flecs workers each run their own pool, but
+  // "Physics Update" is single threaded, so only one pool is busy at a time.
+  // Each flecs stage gets its own draw list.
+  int threads = worker_count;
+  if (threads <= 0)
+    threads = std::clamp((int)std::thread::hardware_concurrency() - 1, 1, 8);
+  int physics_threads =
+      physics_worker_count > 0 ? physics_worker_count : threads;
+  task_scheduler.init(physics_threads);
+  world.set_threads(threads);
+  render_server.set_draw_list_count(world.get_stage_count());
 
   // TODO: For some reason this crashes in debug mode
   // world.import <flecs::stats>();
@@ -64,12 +67,6 @@ void Luxlib::init() {
   world.import <engine_module>();
   world.import <game_module>();
 
-  world.system<cSprite>().kind(flecs::OnLoad).each([](cSprite &sprite) {
-    if (sprite.texture.view.id != 0)
-      return;
-
-    sprite.texture = load_rgba8_image(sprite.path);
-  });
 }
 
 void Luxlib::frame() {
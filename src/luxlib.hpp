@@ -2,14 +2,13 @@
 
 #include "flecs.h"
 #include "server/rendering.hpp"
+#include "server/task_scheduler.hpp"
 #include "sokol_app.h"
 #include "sokol_gfx.h"
 #include "sokol_glue.h"
 #include "sokol_log.h"
 #include "stb/stb_image.h"
 
-GpuTexture load_rgba8_image(std::string path);
-
 class Luxlib {
 private:
   bool initialized;
@@ -18,7 +17,16 @@ private:
   Luxlib() : initialized(false) {}
 
 public:
+  // Threads for multi threaded systems, the main thread included. 0 picks one
+  // less than the core count, up to 8.
+  int worker_count = 0;
+  // Threads for the physics solver. 0 uses worker_count: the solver runs while
+  // the flecs workers are parked, so the two pools do not compete.
+  int physics_worker_count = 0;
+
+  Vfs vfs;
   RenderingServer render_server;
+  TaskScheduler task_scheduler;
   flecs::world world;
   GpuTexture texture;
   GpuTexture texture_circle;
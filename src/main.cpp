@@ -1,11 +1,22 @@
 #include "luxlib.hpp"
 #include "sokol_app.h"
+#include <cstdlib>
+#include <string_view>
 
 void on_init() { Luxlib::instance().init(); }
 void on_frame() { Luxlib::instance().frame(); }
 void on_input(const sapp_event *event) { Luxlib::instance().input(event); }
 
 sapp_desc sokol_main(int argc, char *argv[]) {
+  // --workers <n> overrides the thread count picked from the core count, and
+  // --physics-workers <n> the physics solver's
+  for (int i = 1; i + 1 < argc; i++) {
+    if (std::string_view(argv[i]) == "--workers")
+      Luxlib::instance().worker_count = std::atoi(argv[i + 1]);
+    if (std::string_view(argv[i]) == "--physics-workers")
+      Luxlib::instance().physics_worker_count = std::atoi(argv[i + 1]);
+  }
+
   return (sapp_desc){
       .init_cb = on_init,
       .frame_cb = on_frame,
@@ -0,0 +1,190 @@
+#include "affine2.hpp"
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+auto Affine2::from(glm::vec2 position, float degrees, glm::vec2 scale)
+    -> Affine2 {
+  float rad = glm::radians(degrees);
+  float c = cos(rad);
+  float s = sin(rad);
+  return {.x_axis = {c * scale.x, s * scale.x},
+          .y_axis = {-s * scale.y, c * scale.y},
+          .origin = position};
+}
+
+void TransformBatch::clear() {
+  x.clear();
+  y.clear();
+  rotation.clear();
+  scale_x.clear();
+  scale_y.clear();
+}
+
+void TransformBatch::push(glm::vec2 position, float degrees, glm::vec2 scale) {
+  x.push_back(position.x);
+  y.push_back(position.y);
+  rotation.push_back(degrees);
+  scale_x.push_back(scale.x);
+  scale_y.push_back(scale.y);
+}
+
+// Lane operations the kernel is written against, one set per instruction
+// set. `select_bit` picks `yes` in lanes where `bit` is set in `q`.
+struct ScalarOps {
+  using F = float;
+  using I = int32_t;
+  static constexpr size_t WIDTH = 1;
+
+  static auto load(const float *p) -> F { return *p; }
+  static void store(float *p, F v) { *p = v; }
+  static auto set(float v) -> F { return v; }
+  static auto add(F a, F b) -> F { return a + b; }
+  static auto sub(F a, F b) -> F { return a - b; }
+  static auto mul(F a, F b) -> F { return a * b; }
+  static auto round(F v) -> I { return (I)std::lrint(v); }
+  static auto to_float(I v) -> F { return (F)v; }
+  static auto add(I a, int32_t b) -> I { return a + b; }
+  static auto select_bit(I q, int32_t bit, F yes, F no) -> F {
+    return (q & bit) ? yes : no;
+  }
+};
+
+#if defined(__AVX2__)
+struct SimdOps {
+  using F = __m256;
+  using I = __m256i;
+  static constexpr size_t WIDTH = 8;
+
+  static auto load(const float *p) -> F { return _mm256_loadu_ps(p); }
+  static void store(float *p, F v) { _mm256_storeu_ps(p, v); }
+  static auto set(float v) -> F { return _mm256_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm256_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm256_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm256_mul_ps(a, b); }
+  static auto round(F v) -> I { return _mm256_cvtps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm256_cvtepi32_ps(v); }
+  static auto add(I a, int32_t b) -> I {
+    return _mm256_add_epi32(a, _mm256_set1_epi32(b));
+  }
+  static auto select_bit(I q, int32_t bit, F yes, F no) -> F {
+    __m256i b = _mm256_set1_epi32(bit);
+    __m256 mask =
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, b), b));
+    return _mm256_blendv_ps(no, yes, mask);
+  }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdOps {
+  using F = __m128;
+  using I = __m128i;
+  static constexpr size_t WIDTH = 4;
+
+  static auto load(const float *p) -> F { return _mm_loadu_ps(p); }
+  static void store(float *p, F v) { _mm_storeu_ps(p, v); }
+  static auto set(float v) -> F { return _mm_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm_mul_ps(a, b); }
+  static auto round(F v) -> I { return _mm_cvtps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm_cvtepi32_ps(v); }
+  static auto add(I a, int32_t b) -> I {
+    return _mm_add_epi32(a, _mm_set1_epi32(b));
+  }
+  static auto select_bit(I q, int32_t bit, F yes, F no) -> F {
+    __m128i b = _mm_set1_epi32(bit);
+    __m128 mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, b), b));
+    return _mm_or_ps(_mm_and_ps(mask, yes), _mm_andnot_ps(mask, no));
+  }
+};
+#else
+using SimdOps = ScalarOps;
+#endif
+
+// Transforms entries [first, first + Ops::WIDTH) of the batch.
+template <typename Ops>
+static void compose_lanes(const TransformBatch &batch, size_t first,
+                          const Affine2 &parent, Affine2 *out) {
+  using F = typename Ops::F;
+
+  // Reduce to a quarter turn around the nearest multiple of 90 degrees, where
+  // the Cephes minimax polynomials below are accurate to float precision.
+  F degrees = Ops::load(batch.rotation.data() + first);
+  auto quadrant = Ops::round(Ops::mul(degrees, Ops::set(1.0f / 90.0f)));
+  F r = Ops::mul(Ops::sub(degrees, Ops::mul(Ops::to_float(quadrant),
+                                            Ops::set(90.0f))),
+                 Ops::set(glm::radians(1.0f)));
+  F r2 = Ops::mul(r, r);
+
+  F sin_poly = Ops::add(
+      Ops::set(-1.6666654611e-1f),
+      Ops::mul(r2, Ops::add(Ops::set(8.3321608736e-3f),
+                            Ops::mul(r2, Ops::set(-1.9515295891e-4f)))));
+  F sin_r = Ops::add(r, Ops::mul(Ops::mul(r, r2), sin_poly));
+  F cos_poly = Ops::add(
+      Ops::set(4.166664568298827e-2f),
+      Ops::mul(r2, Ops::add(Ops::set(-1.388731625493765e-3f),
+                            Ops::mul(r2, Ops::set(2.443315711809948e-5f)))));
+  F cos_r = Ops::add(Ops::sub(Ops::set(1.0f), Ops::mul(Ops::set(0.5f), r2)),
+                     Ops::mul(Ops::mul(r2, r2), cos_poly));
+
+  // Odd quadrants swap sine and cosine, the signs follow the quadrant
+  F zero = Ops::set(0.0f);
+  F s = Ops::select_bit(quadrant, 1, cos_r, sin_r);
+  F c = Ops::select_bit(quadrant, 1, sin_r, cos_r);
+  s = Ops::select_bit(quadrant, 2, Ops::sub(zero, s), s);
+  c = Ops::select_bit(Ops::add(quadrant, 1), 2, Ops::sub(zero, c), c);
+
+  F scale_x = Ops::load(batch.scale_x.data() + first);
+  F scale_y = Ops::load(batch.scale_y.data() + first);
+  F local_xx = Ops::mul(c, scale_x);
+  F local_xy = Ops::mul(s, scale_x);
+  F local_yx = Ops::sub(zero, Ops::mul(s, scale_y));
+  F local_yy = Ops::mul(c, scale_y);
+  F local_ox = Ops::load(batch.x.data() + first);
+  F local_oy = Ops::load(batch.y.data() + first);
+
+  // parent * local, with the parent broadcast to every lane
+  F pxx = Ops::set(parent.x_axis.x), pxy = Ops::set(parent.x_axis.y);
+  F pyx = Ops::set(parent.y_axis.x), pyy = Ops::set(parent.y_axis.y);
+  auto rotate_x = [&](F vx, F vy) {
+    return Ops::add(Ops::mul(pxx, vx), Ops::mul(pyx, vy));
+  };
+  auto rotate_y = [&](F vx, F vy) {
+    return Ops::add(Ops::mul(pxy, vx), Ops::mul(pyy, vy));
+  };
+
+  float lanes[6][Ops::WIDTH];
+  Ops::store(lanes[0], rotate_x(local_xx, local_xy));
+  Ops::store(lanes[1], rotate_y(local_xx, local_xy));
+  Ops::store(lanes[2], rotate_x(local_yx, local_yy));
+  Ops::store(lanes[3], rotate_y(local_yx, local_yy));
+  Ops::store(lanes[4], Ops::add(rotate_x(local_ox, local_oy),
+                                Ops::set(parent.origin.x)));
+  Ops::store(lanes[5], Ops::add(rotate_y(local_ox, local_oy),
+                                Ops::set(parent.origin.y)));
+
+  for (size_t lane = 0; lane < Ops::WIDTH; lane++) {
+    out[first + lane] = {.x_axis = {lanes[0][lane], lanes[1][lane]},
+                         .y_axis = {lanes[2][lane], lanes[3][lane]},
+                         .origin = {lanes[4][lane], lanes[5][lane]}};
+  }
+}
+
+void compose_affine2(const TransformBatch &batch, const Affine2 *parent,
+                     Affine2 *out) {
+  Affine2 root = parent ? *parent : Affine2{};
+  size_t count = batch.size();
+  size_t i = 0;
+  for (; i + SimdOps::WIDTH <= count; i += SimdOps::WIDTH) {
+    compose_lanes<SimdOps>(batch, i, root, out);
+  }
+  for (; i < count; i++) {
+    compose_lanes<ScalarOps>(batch, i, root, out);
+  }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <vector>
+
+// 2D affine transform stored as the two basis columns and the translation of
+// a 3x3 matrix whose bottom row is always (0, 0, 1).
+struct Affine2 {
+  glm::vec2 x_axis = {1.0f, 0.0f};
+  glm::vec2 y_axis = {0.0f, 1.0f};
+  glm::vec2 origin = {0.0f, 0.0f};
+
+  // Scale, then rotate by `degrees`, then translate.
+  static auto from(glm::vec2 position, float degrees, glm::vec2 scale)
+      -> Affine2;
+
+  auto operator*(const Affine2 &local) const -> Affine2 {
+    return {.x_axis = transform_vector(local.x_axis),
+            .y_axis = transform_vector(local.y_axis),
+            .origin = transform_point(local.origin)};
+  }
+
+  auto operator==(const Affine2 &other) const -> bool = default;
+
+  auto transform_vector(glm::vec2 v) const -> glm::vec2 {
+    return x_axis * v.x + y_axis * v.y;
+  }
+
+  auto transform_point(glm::vec2 p) const -> glm::vec2 {
+    return x_axis * p.x + y_axis * p.y + origin;
+  }
+
+  auto position() const -> glm::vec2 { return origin; }
+
+  auto rotation() const -> float {
+    return glm::degrees(atan2(x_axis.y, x_axis.x));
+  }
+
+  auto scale() const -> glm::vec2 {
+    return {glm::length(x_axis), glm::length(y_axis)};
+  }
+};
+static_assert(sizeof(Affine2) == 24);
+
+// Local transform inputs with one array per component, the layout the batch
+// kernel loads from.
+struct TransformBatch {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> rotation; // degrees
+  std::vector<float> scale_x;
+  std::vector<float> scale_y;
+
+  void clear();
+  void push(glm::vec2 position, float degrees, glm::vec2 scale);
+  auto size() const -> size_t { return x.size(); }
+};
+
+// Computes parent * local for every entry of `batch` into `out`, which must
+// hold batch.size() transforms. Sine and cosine are evaluated several lanes at
+// a time: AVX2 when the build enables it, SSE2 on other x86-64 builds, and
+// plain scalar code elsewhere.
+void compose_affine2(const TransformBatch &batch, const Affine2 *parent,
+                     Affine2 *out);
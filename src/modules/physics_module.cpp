@@ -11,62 +11,221 @@
 #include "glm/gtc/quaternion.hpp"
 #include "glm/trigonometric.hpp"
 #include "imgui.h"
+#include "render_module.hpp"
 #include "sokol_time.h"
 #include "transform_module.hpp"
+#include <algorithm>
 #include <cstddef>
 #include <ranges>
+#include <vector>
 
+// The debug draw context is the sPhysicsWorld, set by "Draw Physics"
 void draw_physics_solid_circles(b2Transform xform, float radius,
                                 b2HexColor color, void *context) {
-  auto &rendering = Luxlib::instance().render_server;
-  auto &pworld = Luxlib::instance().world.get<sPhysicsWorld>();
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
 
   auto pos = glm::vec2{xform.p.x, xform.p.y} * pworld.pixel_to_meters;
   auto pixel_radius = radius * pworld.pixel_to_meters;
-  rendering.draw_circle(pos, pixel_radius, Srgba::from_hex(color));
+  draw_list.draw_circle(pos, pixel_radius, Srgba::from_hex(color));
 }
 
 void draw_physics_solid_polygon(b2Transform xform, const b2Vec2 *vertices,
                                 int32_t vertexCount, float radius,
                                 b2HexColor color, void *context) {
-  if (vertexCount != 4)
-    return;
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
 
-  auto &rendering = Luxlib::instance().render_server;
-  auto &pworld = Luxlib::instance().world.get<sPhysicsWorld>();
+  glm::vec2 points[B2_MAX_POLYGON_VERTICES];
+  for (int32_t i = 0; i < vertexCount; i++) {
+    auto p = b2TransformPoint(xform, vertices[i]);
+    points[i] = glm::vec2{p.x, p.y} * pworld.pixel_to_meters;
+  }
+  draw_list.draw_polygon(points, vertexCount, Srgba::from_hex(color));
+}
 
-  auto v0 = glm::vec2{vertices[0].x, vertices[0].y} * pworld.pixel_to_meters;
-  auto v1 = glm::vec2{vertices[1].x, vertices[1].y} * pworld.pixel_to_meters;
-  auto v2 = glm::vec2{vertices[2].x, vertices[2].y} * pworld.pixel_to_meters;
-  auto v3 = glm::vec2{vertices[3].x, vertices[3].y} * pworld.pixel_to_meters;
-  rendering.draw_quad(v0, v1, v2, v3,
-                      glm::vec2{xform.p.x, xform.p.y} * pworld.pixel_to_meters,
-                      b2Rot_GetAngle(xform.q), Srgba::from_hex(color));
+void draw_physics_solid_capsule(b2Vec2 p1, b2Vec2 p2, float radius,
+                                b2HexColor color, void *context) {
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
+  auto wp1 = glm::vec2{p1.x, p1.y} * pworld.pixel_to_meters;
+  auto wp2 = glm::vec2{p2.x, p2.y} * pworld.pixel_to_meters;
+  draw_list.draw_capsule(wp1, wp2, radius * pworld.pixel_to_meters,
+                         Srgba::from_hex(color));
 }
 
 void draw_physics_point(b2Vec2 position, float size, b2HexColor color,
                         void *context) {
-  auto &rendering = Luxlib::instance().render_server;
-  auto &pworld = Luxlib::instance().world.get<sPhysicsWorld>();
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
   auto pos = glm::vec2{position.x, position.y} * pworld.pixel_to_meters;
-  rendering.draw_point(pos, Srgba::from_hex(color),
+  draw_list.draw_point(pos, Srgba::from_hex(color),
                        size * pworld.pixel_to_meters);
 }
 
 void draw_physics_transform(const b2Transform xform, void *context) {
-  auto &rendering = Luxlib::instance().render_server;
-  auto &pworld = Luxlib::instance().world.get<sPhysicsWorld>();
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
   auto pos = glm::vec2{xform.p.x, xform.p.y} * pworld.pixel_to_meters;
-  rendering.draw_point(pos, Srgba::from_hex(0xFF0000FF), 1.0f);
+  draw_list.draw_point(pos, Srgba::from_hex(0xFF0000FF), 1.0f);
 }
 
 void draw_physics_segment(b2Vec2 p1, b2Vec2 p2, b2HexColor color,
                           void *context) {
-  auto &rendering = Luxlib::instance().render_server;
-  auto &pworld = Luxlib::instance().world.get<sPhysicsWorld>();
+  auto &draw_list = Luxlib::instance().render_server.get_draw_list();
+  auto &pworld = *(const sPhysicsWorld *)context;
   auto wp1 = glm::vec2{p1.x, p1.y} * pworld.pixel_to_meters;
   auto wp2 = glm::vec2{p2.x, p2.y} * pworld.pixel_to_meters;
-  rendering.draw_line(wp1, wp2, Srgba::from_hex(color));
+  draw_list.draw_line(wp1, wp2, Srgba::from_hex(color));
+}
+
+// Box2D task hooks, run on the engine's task scheduler
+static auto enqueue_physics_task(b2TaskCallback *task, int item_count,
+                                 int min_range, void *task_context,
+                                 void *user_context) -> void * {
+  auto &tasks = *(TaskScheduler *)user_context;
+  return tasks.submit(task, item_count, min_range, task_context);
+}
+
+static void finish_physics_task(void *user_task, void *user_context) {
+  auto &tasks = *(TaskScheduler *)user_context;
+  tasks.wait((TaskScheduler::Task *)user_task);
+}
+
+// One per flecs stage
+static std::vector<PhysicsCommandList> command_lists;
+
+// Orders on the whole id, so a recycled body slot is not merged with the body
+// that used it before
+static auto body_less(b2BodyId a, b2BodyId b) -> bool {
+  if (a.index1 != b.index1)
+    return a.index1 < b.index1;
+  if (a.world0 != b.world0)
+    return a.world0 < b.world0;
+  return a.generation < b.generation;
+}
+
+// Entity of every shape, indexed like Box2D's shape pool. The generation
+// tells a recycled slot from the shape an event was raised for.
+struct ShapeEntity {
+  flecs::entity_t entity;
+  uint16_t generation;
+};
+static std::vector<ShapeEntity> shape_entities;
+
+static void set_shape_entity(b2ShapeId shape, flecs::entity_t entity) {
+  auto index = (size_t)shape.index1;
+  if (index >= shape_entities.size())
+    shape_entities.resize(index + 1);
+  shape_entities[index] = {entity, shape.generation};
+}
+
+static auto shape_entity(b2ShapeId shape) -> flecs::entity_t {
+  auto index = (size_t)shape.index1;
+  if (index >= shape_entities.size() ||
+      shape_entities[index].generation != shape.generation)
+    return 0;
+  return shape_entities[index].entity;
+}
+
+// Appends the sensor and contact events of the last step. Box2D only keeps
+// those of the last one, so this runs after each.
+static void record_collisions(const sPhysicsWorld &pworld,
+                              sPhysicsEvents &events) {
+  auto sensors = b2World_GetSensorEvents(pworld.id);
+  for (int i = 0; i < sensors.beginCount; i++) {
+    auto &event = sensors.beginEvents[i];
+    events.touch_begin.push(shape_entity(event.sensorShapeId),
+                            shape_entity(event.visitorShapeId));
+  }
+  for (int i = 0; i < sensors.endCount; i++) {
+    auto &event = sensors.endEvents[i];
+    events.touch_end.push(shape_entity(event.sensorShapeId),
+                          shape_entity(event.visitorShapeId));
+  }
+
+  auto contacts = b2World_GetContactEvents(pworld.id);
+  for (int i = 0; i < contacts.beginCount; i++) {
+    auto &event = contacts.beginEvents[i];
+    events.contact_begin.push(shape_entity(event.shapeIdA),
+                              shape_entity(event.shapeIdB));
+  }
+  for (int i = 0; i < contacts.endCount; i++) {
+    auto &event = contacts.endEvents[i];
+    events.contact_end.push(shape_entity(event.shapeIdA),
+                            shape_entity(event.shapeIdB));
+  }
+  for (int i = 0; i < contacts.hitCount; i++) {
+    auto &event = contacts.hitEvents[i];
+    events.hits.push(shape_entity(event.shapeIdA),
+                     shape_entity(event.shapeIdB));
+    events.hit_points.push_back(glm::vec2{event.point.x, event.point.y} *
+                                pworld.pixel_to_meters);
+    events.hit_speeds.push_back(event.approachSpeed * pworld.pixel_to_meters);
+  }
+}
+
+// Bodies whose pose changed, kept until their visual is drawn at rest
+static std::vector<flecs::entity_t> moving_bodies;
+
+static auto same_transform(const b2Transform &a, const b2Transform &b)
+    -> bool {
+  return a.p.x == b.p.x && a.p.y == b.p.y && a.q.c == b.q.c && a.q.s == b.q.s;
+}
+
+// Shifts the poses after a step. Box2D only keeps the move events of the last
+// step, so this runs after each one. A moving body the step left alone ends
+// up with both poses equal.
+static void record_body_moves(flecs::world world, b2WorldId world_id) {
+  for (auto id : moving_bodies) {
+    auto e = world.get_alive(id);
+    if (auto pose = e.is_valid() ? e.try_get_mut<cPhysicsPose>() : nullptr)
+      pose->previous = pose->current;
+  }
+
+  auto events = b2World_GetBodyEvents(world_id);
+  for (int i = 0; i < events.moveCount; i++) {
+    auto &move = events.moveEvents[i];
+    auto e = world.get_alive((flecs::entity_t)move.userData);
+    auto pose = e.is_valid() ? e.try_get_mut<cPhysicsPose>() : nullptr;
+    if (!pose)
+      continue;
+
+    // At rest both poses are equal, so it starts from where it was
+    if (!pose->moving) {
+      pose->moving = true;
+      moving_bodies.push_back(e.id());
+    }
+    pose->current = move.transform;
+  }
+}
+
+// Sets the world transform of `e` to `model` and recomposes its descendants
+// from it, so they follow the blended body. Their caches are cleared, so the
+// transform systems put the step pose back next frame.
+static void blend_world_transform(flecs::entity e, const Affine2 &model) {
+  auto xform = e.try_get_mut<cWorldTransform2>();
+  auto cache = e.try_get_mut<cTransformCache>();
+  if (!xform || !cache)
+    return;
+
+  xform->model = model;
+  cache->version = 0;
+  e.modified<cWorldTransform2>();
+  // Roots are only revisited in tables whose local transform changed
+  e.modified<cPosition2>();
+
+  e.children([&model](flecs::entity child) {
+    auto position = child.try_get<cPosition2>();
+    auto rotation = child.try_get<cRotation2>();
+    auto scale = child.try_get<cScale2>();
+    if (!position || !rotation || !scale)
+      return;
+
+    blend_world_transform(child, model * Affine2::from(position->value,
+                                                       rotation->value,
+                                                       scale->value));
+  });
 }
 
 void init_entity_physics_shape(const sPhysicsWorld &pworld, flecs::entity root,
@@ -76,7 +235,6 @@ void init_entity_physics_shape(const sPhysicsWorld &pworld, flecs::entity root,
     return;
 
   b2ShapeDef shape_def = b2DefaultShapeDef();
-  shape_def.userData = (void *)e.id();
   if (auto density = e.try_get<cDensity>())
     shape_def.density = density->value;
 
@@ -88,6 +246,7 @@ void init_entity_physics_shape(const sPhysicsWorld &pworld, flecs::entity root,
 
   shape_def.isSensor = e.has<cSensor>();
   shape_def.enableSensorEvents = shape_def.isSensor || e.has<cSensorEvents>();
+  shape_def.enableHitEvents = !shape_def.isSensor;
 
   auto center = b2Vec2_zero;
   if (e != root) {
@@ -115,6 +274,7 @@ void init_entity_physics_shape(const sPhysicsWorld &pworld, flecs::entity root,
   }
   }
 
+  set_shape_entity(shape->id, e.id());
   e.add<rPhysicsRoot>(root);
 }
 
@@ -122,6 +282,7 @@ physics_module::physics_module(flecs::world &world) {
   world.module<physics_module>();
 
   world.component<eApplyForce>();
+  command_lists.resize(std::max(world.get_stage_count(), 1));
 
   world.component<b2WorldId>().member<uint16_t>("index").member<uint16_t>(
       "generation");
@@ -130,7 +291,13 @@ physics_module::physics_module(flecs::world &world) {
 
   world.component<sPhysicsTime>()
       .member<uint64_t>("last_time")
+      .member<float>("acc")
       .member<float>("fixed_dt")
+      .member<float>("scale")
+      .member<int32_t>("max_steps")
+      .member<uint32_t>("dropped_steps")
+      .member<int32_t>("steps")
+      .member<float>("alpha")
       .add(flecs::Singleton);
   world.add<sPhysicsTime>();
 
@@ -151,19 +318,20 @@ physics_module::physics_module(flecs::world &world) {
   world.component<sPhysicsDebugDraw>().member<b2DebugDraw>("debug").add(
       flecs::Singleton);
 
-  world.component<eTouchBegin>()
-      .member<flecs::entity>("sensor")
-      .member<flecs::entity>("visitor");
-  world.component<eTouchEnd>()
-      .member<flecs::entity>("sensor")
-      .member<flecs::entity>("visitor");
+  world.component<sPhysicsEvents>().add(flecs::Singleton);
+  world.add<sPhysicsEvents>();
 
   // World management
   world.observer<sPhysicsWorld>()
       .event(flecs::OnAdd)
       .each([](sPhysicsWorld &world) {
+        auto &tasks = Luxlib::instance().task_scheduler;
         b2WorldDef pworld_def = b2DefaultWorldDef();
         pworld_def.gravity = {0.0, -9.8};
+        pworld_def.workerCount = tasks.get_worker_count();
+        pworld_def.enqueueTask = enqueue_physics_task;
+        pworld_def.finishTask = finish_physics_task;
+        pworld_def.userTaskContext = &tasks;
         world.pixel_to_meters = 32;
         world.id = b2CreateWorld(&pworld_def);
       });
@@ -177,9 +345,10 @@ physics_module::physics_module(flecs::world &world) {
   auto debug_draw = b2DefaultDebugDraw();
   debug_draw.drawShapes = true;
   debug_draw.drawMass = true;
-  debug_draw.useDrawingBounds = false;
+  debug_draw.useDrawingBounds = true;
   debug_draw.DrawSolidCircleFcn = draw_physics_solid_circles;
   debug_draw.DrawSolidPolygonFcn = draw_physics_solid_polygon;
+  debug_draw.DrawSolidCapsuleFcn = draw_physics_solid_capsule;
   debug_draw.DrawTransformFcn = draw_physics_transform;
   debug_draw.DrawPointFcn = draw_physics_point;
   debug_draw.DrawSegmentFcn = draw_physics_segment;
@@ -199,6 +368,7 @@ physics_module::physics_module(flecs::world &world) {
   world.component<cPhysicsBody>()
       .member<b2BodyId>("id")
       .add(flecs::With, world.component<cWorldTransform2>())
+      .add(flecs::With, world.component<cPhysicsPose>())
       .add(flecs::With, world.component<cFriction>())
       .add(flecs::With, world.component<cRestitution>())
       .add(flecs::With, world.component<cPhysicsShape>())
@@ -206,6 +376,7 @@ physics_module::physics_module(flecs::world &world) {
       .add(flecs::With, world.component<cPhysicsInit>())
       .add(flecs::With, world.component<cDensity>());
 
+  world.component<cPhysicsPose>();
   world.component<cFriction>().member<float>("value");
   world.component<cDensity>().member<float>("value");
   world.component<cRestitution>().member<float>("value");
@@ -231,7 +402,7 @@ physics_module::physics_module(flecs::world &world) {
                const cPhysicsBodyType &body_type, cPhysicsShape &shape,
                cPosition2 *pos, cRotation2 *rot) {
         b2BodyDef body_def = b2DefaultBodyDef();
-        body_def.userData = &e;
+        body_def.userData = (void *)e.id();
         switch (body_type) {
         case Dynamic:
           body_def.type = b2_dynamicBody;
@@ -241,6 +412,8 @@ physics_module::physics_module(flecs::world &world) {
           break;
         case Static:
           body_def.type = b2_staticBody;
+          // Anything drawn on a static body is static too
+          e.add<cStaticVisual>();
           break;
         }
 
@@ -250,6 +423,10 @@ physics_module::physics_module(flecs::world &world) {
         if (rot)
           body_def.rotation = b2MakeRot(glm::radians(rot->value));
         body.id = b2CreateBody(pworld.id, &body_def);
+        if (auto pose = e.try_get_mut<cPhysicsPose>()) {
+          auto xform = b2Transform{body_def.position, body_def.rotation};
+          *pose = {.previous = xform, .current = xform, .moving = false};
+        }
 
         init_entity_physics_shape(pworld, e, e, body.id);
 
@@ -266,86 +443,189 @@ physics_module::physics_module(flecs::world &world) {
           [](flecs::entity e, cPhysicsBody &body) { b2DestroyBody(body.id); });
 
   // Process
-  world.system<const sPhysicsWorld, sPhysicsTime>("Physics Update")
+  world
+      .system<const sPhysicsWorld, sPhysicsTime, sPhysicsEvents>(
+          "Physics Update")
       .kind(flecs::PreUpdate)
       .each([](flecs::iter &it, size_t, const sPhysicsWorld &world,
-               sPhysicsTime &time) {
+               sPhysicsTime &time, sPhysicsEvents &events) {
         // Iterate physics
         time.acc += stm_sec(stm_since(time.last_time)) * time.scale;
         time.last_time = stm_now();
+        events.clear();
         auto iterations = 0;
         while (time.fixed_dt > 0.0f && time.acc >= time.fixed_dt) {
+          // Catching up on a long frame would make the next one longer still
+          if (iterations == time.max_steps) {
+            auto dropped = (uint32_t)(time.acc / time.fixed_dt);
+            time.dropped_steps += dropped;
+            time.acc -= (float)dropped * time.fixed_dt;
+            break;
+          }
+
+          apply_commands();
           b2World_Step(world.id, time.fixed_dt, 4);
+          record_body_moves(it.world(), world.id);
+          record_collisions(world, events);
           time.acc -= time.fixed_dt;
           iterations += 1;
         }
+        time.steps = iterations;
+        time.alpha = time.fixed_dt > 0.0f ? time.acc / time.fixed_dt : 0.0f;
+      });
 
-        // Return early to avoid raising the same events multiple frames
-        if (iterations == 0)
+  // Gameplay sees the pose of the last step. Only bodies that moved are
+  // written, so resting and static bodies cost nothing.
+  world
+      .system<const sPhysicsWorld, const sPhysicsTime>(
+          "Sync Physics Transforms")
+      .kind(flecs::PreUpdate)
+      .each([](flecs::iter &it, size_t, const sPhysicsWorld &pworld,
+               const sPhysicsTime &time) {
+        if (time.steps == 0)
           return;
 
-        // Trigger sensor events
-        auto sensor_events = b2World_GetSensorEvents(world.id);
-        for (int i = 0; i < sensor_events.beginCount; ++i) {
-          auto begin_event = sensor_events.beginEvents + i;
-          auto visitor_id =
-              (flecs::entity_t)b2Shape_GetUserData(begin_event->visitorShapeId);
-          auto visitor = it.world().get_alive(visitor_id);
-          auto sensor_id =
-              (flecs::entity_t)b2Shape_GetUserData(begin_event->sensorShapeId);
-          auto sensor = it.world().get_alive(sensor_id);
-          if (visitor && visitor.is_valid() && sensor && sensor.is_valid()) {
-            emit_event<eTouchBegin, cSensor>(
-                sensor, {.sensor = sensor, .visitor = visitor});
+        auto world = it.world();
+        for (auto id : moving_bodies) {
+          auto e = world.get_alive(id);
+          auto pose = e.is_valid() ? e.try_get<cPhysicsPose>() : nullptr;
+          if (!pose)
+            continue;
+
+          auto &current = pose->current;
+          if (auto position = e.try_get_mut<cPosition2>()) {
+            position->value =
+                glm::vec2{current.p.x, current.p.y} * pworld.pixel_to_meters;
+            e.modified<cPosition2>();
+          }
+          if (auto rotation = e.try_get_mut<cRotation2>()) {
+            rotation->value = glm::degrees(b2Rot_GetAngle(current.q));
+            e.modified<cRotation2>();
           }
         }
+      });
 
-        for (int i = 0; i < sensor_events.endCount; ++i) {
-          auto end_event = sensor_events.endEvents + i;
-          auto visitor_id =
-              (flecs::entity_t)b2Shape_GetUserData(end_event->visitorShapeId);
-          auto visitor = it.world().get_alive(visitor_id);
-          auto sensor_id =
-              (flecs::entity_t)b2Shape_GetUserData(end_event->sensorShapeId);
-          auto sensor = it.world().get_alive(sensor_id);
-          if (visitor && visitor.is_valid() && sensor && sensor.is_valid()) {
-            emit_event<eTouchEnd, cSensor>(
-                visitor, {.sensor = sensor, .visitor = visitor});
+  // Bodies are drawn between the last two steps, blended by alpha, so they
+  // move smoothly at any frame rate. Only world transforms are blended, which
+  // just rendering reads, so this runs right after the transform systems
+  // (imported before this module) and before visuals and labels are drawn.
+  world
+      .system<const sPhysicsWorld, const sPhysicsTime>(
+          "Interpolate Physics Transforms")
+      .kind(flecs::OnUpdate)
+      .write<cWorldTransform2>()
+      .write<cPosition2>()
+      .each([](flecs::iter &it, size_t, const sPhysicsWorld &pworld,
+               const sPhysicsTime &time) {
+        auto world = it.world();
+        for (size_t i = 0; i < moving_bodies.size();) {
+          auto e = world.get_alive(moving_bodies[i]);
+          auto pose = e.is_valid() ? e.try_get_mut<cPhysicsPose>() : nullptr;
+          if (!pose) {
+            moving_bodies[i] = moving_bodies.back();
+            moving_bodies.pop_back();
+            continue;
           }
+
+          // Bodies are roots, so the blended pose is their world transform
+          auto p = b2Lerp(pose->previous.p, pose->current.p, time.alpha);
+          auto q = b2NLerp(pose->previous.q, pose->current.q, time.alpha);
+          auto scale = e.try_get<cScale2>();
+          blend_world_transform(
+              e, Affine2::from(glm::vec2{p.x, p.y} * pworld.pixel_to_meters,
+                               glm::degrees(b2Rot_GetAngle(q)),
+                               scale ? scale->value : glm::vec2{1.0f, 1.0f}));
+
+          // Came to rest and is now drawn there
+          if (same_transform(pose->previous, pose->current)) {
+            pose->moving = false;
+            moving_bodies[i] = moving_bodies.back();
+            moving_bodies.pop_back();
+            continue;
+          }
+          i++;
         }
       });
 
   world.system<const sPhysicsWorld, sPhysicsDebugDraw>("Draw Physics")
       .each([](const sPhysicsWorld &pworld, sPhysicsDebugDraw &draw) {
         auto &rendering = Luxlib::instance().render_server;
-        b2World_Draw(pworld.id, &draw.debug);
-      });
 
-  // Sync position and rotation from physics
-  // TODO: Use body events instead for better performance
-  world
-      .system<const sPhysicsWorld, const cPhysicsBody, cPosition2>(
-          "Sync Position to Physics")
-      .kind(flecs::OnUpdate)
-      .each([](const sPhysicsWorld &pworld, const cPhysicsBody &body,
-               cPosition2 &position) {
-        b2Vec2 pos = b2Body_GetPosition(body.id);
-        position.value.x = pos.x * pworld.pixel_to_meters;
-        position.value.y = pos.y * pworld.pixel_to_meters;
-      });
-
-  world.system<const cPhysicsBody, cRotation2>("Sync Rotation to Physics")
-      .kind(flecs::OnUpdate)
-      .each([](const cPhysicsBody &body, cRotation2 &rotation) {
-        b2Rot pos = b2Body_GetRotation(body.id);
-        rotation.value = glm::degrees(b2Rot_GetAngle(pos));
+        // Only shapes inside the camera are sent to the renderer
+        auto bounds = rendering.get_camera_bounds();
+        draw.debug.drawingBounds = {
+            .lowerBound = {bounds.min.x / pworld.pixel_to_meters,
+                           bounds.min.y / pworld.pixel_to_meters},
+            .upperBound = {bounds.max.x / pworld.pixel_to_meters,
+                           bounds.max.y / pworld.pixel_to_meters}};
+        draw.debug.context = (void *)&pworld;
+        b2World_Draw(pworld.id, &draw.debug);
       });
 
   // Apply force
   world.observer<cPhysicsBody>().event<eApplyForce>().each(
       [](flecs::iter &it, size_t, cPhysicsBody &body) {
         auto force = it.param<eApplyForce>()->force;
-        spdlog::info("Applying force {}, {}", force.x, force.y);
-        b2Body_ApplyForce(body.id, {force.x, force.y}, b2Vec2_zero, true);
+        get_commands(it.world().get_stage_id()).apply_force(body.id, force);
       });
 }
+
+auto physics_module::get_commands(int stage) -> PhysicsCommandList & {
+  return command_lists[stage];
+}
+
+void physics_module::apply_commands() {
+  using Kind = PhysicsCommandList::Kind;
+  static std::vector<PhysicsCommandList::Command> queued_commands;
+
+  // Stage order first, then a stable sort, so a body's commands keep the
+  // order they were queued in however systems were scheduled
+  queued_commands.clear();
+  for (auto &list : command_lists) {
+    queued_commands.insert(queued_commands.end(), list.commands.begin(),
+                           list.commands.end());
+    list.commands.clear();
+  }
+  std::stable_sort(queued_commands.begin(), queued_commands.end(),
+                   [](const auto &a, const auto &b) {
+                     return body_less(a.body, b.body);
+                   });
+
+  for (size_t i = 0; i < queued_commands.size();) {
+    auto body = queued_commands[i].body;
+    b2Vec2 force = b2Vec2_zero;
+    const b2Vec2 *linear = nullptr;
+    const float *angular = nullptr;
+    for (; i < queued_commands.size() &&
+           B2_ID_EQUALS(queued_commands[i].body, body);
+         i++) {
+      auto &command = queued_commands[i];
+      switch (command.kind) {
+      case Kind::Force:
+        force = b2Add(force, command.value);
+        break;
+      case Kind::LinearVelocity:
+        linear = &command.value;
+        break;
+      case Kind::AngularVelocity:
+        angular = &command.value.x;
+        break;
+      }
+    }
+
+    if (!b2Body_IsValid(body))
+      continue;
+
+    if (force.x != 0.0f || force.y != 0.0f)
+      b2Body_ApplyForceToCenter(body, force, true);
+
+    if (linear) {
+      auto current = b2Body_GetLinearVelocity(body);
+      if (current.x != linear->x || current.y != linear->y)
+        b2Body_SetLinearVelocity(body, *linear);
+    }
+
+    if (angular && b2Body_GetAngularVelocity(body) != *angular)
+      b2Body_SetAngularVelocity(body, *angular);
+  }
+}
@@ -11,12 +11,20 @@
 #include "glm/ext/vector_float2.hpp"
 #include "spdlog/spdlog.h"
 #include "transform_module.hpp"
+#include <vector>
 
 struct sPhysicsTime {
   uint64_t last_time = 0;
   float acc = 0;
   float fixed_dt = 0.016f;
   float scale = 2.5f;
+  // Steps run in one frame at most, time beyond them is dropped
+  int32_t max_steps = 4;
+  uint32_t dropped_steps = 0;
+  // Steps run this frame
+  int32_t steps = 0;
+  // How far the accumulator is into the next step, used to blend poses
+  float alpha = 0;
 };
 
 struct cPhysicsInit {};
@@ -39,6 +47,15 @@ struct cPhysicsBody {
   b2BodyId id;
 };
 
+// Body transform after the last two steps. cPosition2 and cRotation2 hold
+// `current`, while the world transforms of the body and its descendants are
+// blended between the two by sPhysicsTime::alpha.
+struct cPhysicsPose {
+  b2Transform previous;
+  b2Transform current;
+  bool moving;
+};
+
 struct cFriction {
   float value;
 };
@@ -71,25 +88,94 @@ struct cSensorEvents {};
 
 struct rPhysicsRoot {};
 
-struct eTouchBegin {
-  flecs::entity sensor;
-  flecs::entity visitor;
+// Entity pairs kept as two parallel arrays
+struct PhysicsEventPairs {
+  std::vector<flecs::entity_t> first;
+  std::vector<flecs::entity_t> second;
+
+  void push(flecs::entity_t a, flecs::entity_t b) {
+    first.push_back(a);
+    second.push_back(b);
+  }
+
+  void clear() {
+    first.clear();
+    second.clear();
+  }
+
+  auto size() const -> size_t { return first.size(); }
 };
 
-struct eTouchEnd {
-  flecs::entity sensor;
-  flecs::entity visitor;
+// Collision events of every step run this frame, with shapes resolved to their
+// entities. Cleared at the start of every physics update, so they are empty on
+// frames that do not step. An entity is 0 if its shape was destroyed meanwhile.
+struct sPhysicsEvents {
+  PhysicsEventPairs touch_begin; // sensor, visitor
+  PhysicsEventPairs touch_end;   // sensor, visitor
+  PhysicsEventPairs contact_begin;
+  PhysicsEventPairs contact_end;
+
+  // Contacts that began faster than the world's hit event threshold
+  PhysicsEventPairs hits;
+  std::vector<glm::vec2> hit_points; // pixels
+  std::vector<float> hit_speeds;     // approach speed in pixels per second
+
+  void clear() {
+    touch_begin.clear();
+    touch_end.clear();
+    contact_begin.clear();
+    contact_end.clear();
+    hits.clear();
+    hit_points.clear();
+    hit_speeds.clear();
+  }
+};
+
+// Box2D writes queued by one flecs stage, so multi threaded systems can queue
+// without locking. All lists are applied in one pass right before the next
+// step, merged per body: forces add up and the last velocity set wins.
+// Commands queued in frames that do not step wait for the next one, so forces
+// from those frames add up like Box2D's own force accumulator does.
+class PhysicsCommandList {
+private:
+  friend struct physics_module;
+
+  enum class Kind : uint8_t { Force, LinearVelocity, AngularVelocity };
+
+  struct Command {
+    b2BodyId body;
+    Kind kind;
+    b2Vec2 value; // angular velocity in x
+  };
+
+  std::vector<Command> commands;
+
+public:
+  void apply_force(b2BodyId body, glm::vec2 force) {
+    commands.push_back({body, Kind::Force, {force.x, force.y}});
+  }
+
+  void set_linear_velocity(b2BodyId body, glm::vec2 velocity) {
+    commands.push_back({body, Kind::LinearVelocity, {velocity.x, velocity.y}});
+  }
+
+  // Radians per second
+  void set_angular_velocity(b2BodyId body, float velocity) {
+    commands.push_back({body, Kind::AngularVelocity, {velocity, 0.0f}});
+  }
 };
 
 struct physics_module {
   physics_module(flecs::world &world);
 
+  // Commands of the given flecs stage, 0 for single threaded systems.
+  static auto get_commands(int stage = 0) -> PhysicsCommandList &;
+
+  // Applies every queued command, skipping writes that change nothing.
+  static void apply_commands();
+
   static void apply_force(flecs::entity e, const glm::vec2 &force) {
-    e.world()
-        .event<eApplyForce>()
-        .id<cPhysicsBody>()
-        .entity(e)
-        .ctx({.force = force})
-        .emit();
+    if (auto body = e.try_get<cPhysicsBody>())
+      get_commands(e.world().get_stage_id()).apply_force(body->id, force);
   }
 };
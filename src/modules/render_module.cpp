@@ -15,9 +15,12 @@ render_module::render_module(flecs::world &world) {
 
   world.component<cMainCamera>();
 
+  world.component<cStaticVisual>();
+
   world.component<cSprite>()
       .member<std::string>("path")
       .member<glm::vec2>("size")
+      .member<uint8_t>("layer")
       .add(flecs::With, world.component<cVisual2Handle>())
       .add(flecs::With, world.component<cWorldTransform2>());
 
@@ -43,24 +46,49 @@ render_module::render_module(flecs::world &world) {
         render_server.delete_visual2(handle.id);
       });
 
-  world.observer<const cSprite, cVisual2Handle>()
+  world.observer<cSprite, cVisual2Handle>()
       .event(flecs::OnSet)
-      .each([&render_server](const cSprite &sprite, cVisual2Handle &handle) {
-        auto &visual = render_server.get_visual2(handle.id);
-        visual.size = sprite.size;
-        visual.texture = sprite.texture;
+      .each([&render_server](cSprite &sprite, cVisual2Handle &handle) {
+        sprite.texture = render_server.intern_texture(sprite.path);
+        render_server.set_visual2_size(handle.id, sprite.size);
+        render_server.set_visual2_texture(handle.id, sprite.texture);
+        render_server.set_visual2_layer(handle.id, sprite.layer);
+      });
+
+  world.observer<const cVisual2Handle>()
+      .with<cStaticVisual>()
+      .event(flecs::OnAdd)
+      .each([&render_server](const cVisual2Handle &handle) {
+        render_server.set_visual2_static(handle.id, true);
       });
 
+  world.observer<const cVisual2Handle>()
+      .with<cStaticVisual>()
+      .event(flecs::OnRemove)
+      .each([&render_server](const cVisual2Handle &handle) {
+        render_server.set_visual2_static(handle.id, false);
+      });
+
+  // Sprite fields reach the visual through the OnSet observer above, so only
+  // transforms are synced here, and only for tables written since last frame.
   world
-      .system<cVisual2Handle, const cSprite, const cWorldTransform2>(
-          "Update Visual2")
+      .system<const cVisual2Handle, const cWorldTransform2>("Update Visual2")
+      .with<cSprite>()
+      .detect_changes()
       .kind(flecs::PreStore)
-      .each([&render_server](cVisual2Handle &handle, const cSprite sprite,
-                             const cWorldTransform2 &xform) {
-        auto &visual = render_server.get_visual2(handle.id);
-        visual.model = xform.model;
-        visual.size = sprite.size;
-        visual.texture = sprite.texture;
+      .run([&render_server](flecs::iter &it) {
+        while (it.next()) {
+          if (!it.changed()) {
+            it.skip();
+            continue;
+          }
+
+          auto handles = it.field<const cVisual2Handle>(0);
+          auto xforms = it.field<const cWorldTransform2>(1);
+          for (auto i : it) {
+            render_server.set_visual2_model(handles[i].id, xforms[i].model);
+          }
+        }
       });
 
   world.system<const cCamera>("Sync camera zoom")
@@ -79,13 +107,12 @@ render_module::render_module(flecs::world &world) {
 
   world.system<const cLabel, const cWorldTransform2, cTint *>("Draw text")
       .kind(flecs::PostUpdate)
-      .each([&render_server](const cLabel &label, const cWorldTransform2 &xform,
-                             const cTint *tint) {
+      .multi_threaded()
+      .each([&render_server](flecs::iter &it, size_t, const cLabel &label,
+                             const cWorldTransform2 &xform, const cTint *tint) {
         auto color = tint ? tint->color : WHITE;
-        auto pos = xform.position();
-        auto real_pos = render_server.world_to_screen(pos);
-        auto real_size = label.size * render_server.get_camera_zoom();
-        Luxlib::instance().render_server.draw_text(
-            real_pos.x, real_pos.y, label.text.c_str(), real_size, color);
+        auto stage = it.world().get_stage_id();
+        render_server.get_draw_list(stage).draw_text(
+            xform.position(), label.text, label.size, color);
       });
 }
@@ -9,7 +9,9 @@
 struct cSprite {
   std::string path;
   glm::vec2 size;
-  GpuTexture texture;
+  uint8_t layer = 0;
+  // Interned from `path` when the sprite is set
+  TextureId texture = 0;
 };
 
 struct cVisual2Handle {
@@ -18,6 +20,10 @@ struct cVisual2Handle {
 
 struct cMainCamera {};
 
+// Sprites that never move. They are baked into the renderer's static layer,
+// so changing them afterwards triggers a rebuild.
+struct cStaticVisual {};
+
 struct cTint {
   Srgba color;
 };
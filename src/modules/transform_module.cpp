@@ -2,6 +2,65 @@
 #include "glm/ext/vector_float2.hpp"
 #include "glm/glm.hpp"
 #include "glm/trigonometric.hpp"
+#include <atomic>
+
+// Source of cTransformCache versions. Being unique, a child also notices when
+// it moves to another parent.
+static std::atomic<uint32_t> transform_version = 0;
+
+// Summed by the update systems from any thread, published once they are done
+static std::atomic<uint32_t> stats_updated = 0;
+static std::atomic<uint32_t> stats_total = 0;
+
+// Dirty entities of the current table, gathered so the batch kernel can run
+// over all of them at once
+static thread_local TransformBatch dirty_batch;
+static thread_local std::vector<uint32_t> dirty_rows;
+static thread_local std::vector<Affine2> dirty_models;
+
+// Recomputes the entities of the table whose local transform or parent changed
+// since they were last updated. Returns how many were.
+static auto update_table(flecs::iter &it, const Affine2 *parent_model,
+                         uint32_t parent_version) -> uint32_t {
+  auto world_out = it.field<cWorldTransform2>(0);
+  auto caches = it.field<cTransformCache>(1);
+  auto local_pos = it.field<const cPosition2>(2);
+  auto local_rot = it.field<const cRotation2>(3);
+  auto local_scale = it.field<const cScale2>(4);
+
+  dirty_batch.clear();
+  dirty_rows.clear();
+  for (auto i : it) {
+    auto &cache = caches[i];
+    if (cache.version != 0 && cache.parent_version == parent_version &&
+        cache.position == local_pos[i].value &&
+        cache.rotation == local_rot[i].value &&
+        cache.scale == local_scale[i].value)
+      continue;
+
+    dirty_batch.push(local_pos[i].value, local_rot[i].value,
+                     local_scale[i].value);
+    dirty_rows.push_back((uint32_t)i);
+  }
+
+  uint32_t updated = (uint32_t)dirty_rows.size();
+  if (updated == 0)
+    return 0;
+
+  dirty_models.resize(updated);
+  compose_affine2(dirty_batch, parent_model, dirty_models.data());
+  uint32_t version = transform_version.fetch_add(updated) + 1;
+  for (uint32_t n = 0; n < updated; n++) {
+    auto i = dirty_rows[n];
+    world_out[i].model = dirty_models[n];
+    caches[i] = {.position = local_pos[i].value,
+                 .rotation = local_rot[i].value,
+                 .scale = local_scale[i].value,
+                 .version = version + n,
+                 .parent_version = parent_version};
+  }
+  return updated;
+}
 
 transform_module::transform_module(flecs::world &world) {
   world.module<transform_module>();
@@ -10,43 +69,96 @@ transform_module::transform_module(flecs::world &world) {
   world.component<cRotation2>().member<float>("value");
   world.component<cScale2>().member<glm::vec2>("value");
 
+  world.component<cTransformCache>();
+  world.component<sTransformStats>()
+      .member<uint32_t>("updated")
+      .member<uint32_t>("total");
+  world.set<sTransformStats>({});
+
   world.component<cWorldTransform2>()
+      .add(flecs::With, world.component<cTransformCache>())
       .add(flecs::With, world.component<cPosition2>())
       .add(flecs::With, world.component<cRotation2>())
       .add(flecs::With, world.component<cScale2>());
 
+  // Roots do not depend on each other, so their tables are spread over the
+  // worker threads. Children wait for them and go in hierarchy order.
+  world
+      .system<cWorldTransform2, cTransformCache, const cPosition2,
+              const cRotation2, const cScale2>("Update World Transform")
+      .without(flecs::ChildOf, flecs::Wildcard)
+      .detect_changes()
+      .multi_threaded()
+      .run([](flecs::iter &it) {
+        uint32_t total = 0;
+        uint32_t updated = 0;
+        while (it.next()) {
+          total += (uint32_t)it.count();
+
+          // Only a table with one of its components written since the last
+          // run can hold dirty roots
+          if (!it.changed()) {
+            it.skip();
+            continue;
+          }
+
+          // Leaves the columns unmarked so downstream change detection
+          // skips this table too
+          uint32_t count = update_table(it, nullptr, 0);
+          if (count == 0)
+            it.skip();
+          updated += count;
+        }
+        stats_total += total;
+        stats_updated += updated;
+      });
+
   world
-      .system<cWorldTransform2, const cPosition2, const cRotation2,
-              const cScale2, const cWorldTransform2 *>("Update World Transform")
-      .term_at(4)
+      .system<cWorldTransform2, cTransformCache, const cPosition2,
+              const cRotation2, const cScale2, const cWorldTransform2 *,
+              const cTransformCache *>("Update Child World Transform")
+      .with(flecs::ChildOf, flecs::Wildcard)
+      .term_at(5)
       .parent()
       .cascade()
       .optional()
-      .each([](cWorldTransform2 &world_out, const cPosition2 &local_pos,
-               const cRotation2 &local_rot, const cScale2 &local_scale,
-               const cWorldTransform2 *parent_world) {
-        // Build Local Matrix
-        glm::mat3 local = glm::mat3(1.0f);
-
-        float rad = glm::radians(local_rot.value);
-        float cos_a = cos(rad);
-        float sin_a = sin(rad);
-
-        local[0][0] = cos_a * local_scale.value.x;
-        local[1][0] = -sin_a * local_scale.value.y;
-        local[2][0] = local_pos.value.x;
-        local[0][1] = sin_a * local_scale.value.x;
-        local[1][1] = cos_a * local_scale.value.y;
-        local[2][1] = local_pos.value.y;
-        local[0][2] = 0.0f;
-        local[1][2] = 0.0f;
-        local[2][2] = 1.0f;
-
-        // 2. Combine with Parent
-        if (parent_world) {
-          world_out.model = parent_world->model * local;
-        } else {
-          world_out.model = local;
+      .term_at(6)
+      .parent()
+      .optional()
+      .detect_changes()
+      .run([](flecs::iter &it) {
+        uint32_t total = 0;
+        uint32_t updated = 0;
+        while (it.next()) {
+          total += (uint32_t)it.count();
+
+          // A parent without a world transform leaves the table a root
+          bool has_parent = it.is_set(5);
+          if (!has_parent && !it.changed()) {
+            it.skip();
+            continue;
+          }
+
+          // ChildOf is part of the table type, so the parent is shared
+          const Affine2 *parent_model = nullptr;
+          uint32_t parent_version = 0;
+          if (has_parent) {
+            parent_model = &it.field<const cWorldTransform2>(5)[0].model;
+            if (it.is_set(6))
+              parent_version = it.field<const cTransformCache>(6)[0].version;
+          }
+
+          uint32_t count = update_table(it, parent_model, parent_version);
+          if (count == 0)
+            it.skip();
+          updated += count;
         }
+        stats_total += total;
+        stats_updated += updated;
       });
+
+  world.system("Publish Transform Stats").run([](flecs::iter &it) {
+    it.world().set(sTransformStats{.updated = stats_updated.exchange(0),
+                                   .total = stats_total.exchange(0)});
+  });
 }
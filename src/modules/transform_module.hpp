@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../math/affine2.hpp"
 #include "flecs.h"
 #include "glm/ext/vector_float2.hpp"
 #include "glm/glm.hpp"
@@ -17,19 +18,27 @@ struct cScale2 {
 };
 
 struct cWorldTransform2 {
-  glm::mat3 model;
+  Affine2 model;
 
-  auto position() const -> glm::vec2 {
-    return glm::vec2{model[2][0], model[2][1]};
-  }
+  auto position() const -> glm::vec2 { return model.position(); }
+  auto rotation() const -> float { return model.rotation(); }
+  auto scale() const -> glm::vec2 { return model.scale(); }
+};
 
-  auto rotation() const -> float {
-    return glm::degrees(atan2(model[1][0], model[0][0]));
-  }
+// Inputs of the last world transform computed for an entity. Entities whose
+// local transform and parent are unchanged since then are skipped.
+struct cTransformCache {
+  glm::vec2 position;
+  float rotation;
+  glm::vec2 scale;
+  // Unique per computed transform, 0 before the first one
+  uint32_t version;
+  uint32_t parent_version;
+};
 
-  auto scale() const -> glm::vec2 {
-    return glm::vec2{glm::length(model[0]), glm::length(model[1])};
-  }
+struct sTransformStats {
+  uint32_t updated; // world transforms recomputed last frame
+  uint32_t total;
 };
 
 struct transform_module {
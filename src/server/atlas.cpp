@@ -0,0 +1,293 @@
+#include "atlas.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : width(width), height(height) {
+  reset();
+}
+
+void SkylinePacker::reset() {
+  if (!pinned.empty()) {
+    skyline = pinned;
+    return;
+  }
+  skyline.clear();
+  skyline.push_back({0, 0, width});
+}
+
+void SkylinePacker::pin() { pinned = skyline; }
+
+// Returns the y the rectangle would rest at when placed on `index`, or -1.
+auto SkylinePacker::fits(size_t index, int w, int h) const -> int {
+  int x = skyline[index].x;
+  if (x + w > width)
+    return -1;
+
+  int y = skyline[index].y;
+  int width_left = w;
+  while (width_left > 0) {
+    if (index == skyline.size())
+      return -1;
+
+    y = std::max(y, skyline[index].y);
+    if (y + h > height)
+      return -1;
+
+    width_left -= skyline[index].width;
+    index++;
+  }
+
+  return y;
+}
+
+void SkylinePacker::add_level(size_t index, int x, int y, int w, int h) {
+  skyline.insert(skyline.begin() + index, {x, y + h, w});
+
+  // Trim the nodes now covered by the new one
+  for (size_t i = index + 1; i < skyline.size(); i++) {
+    auto &prev = skyline[i - 1];
+    auto &node = skyline[i];
+    if (node.x >= prev.x + prev.width)
+      break;
+
+    int shrink = prev.x + prev.width - node.x;
+    node.x += shrink;
+    node.width -= shrink;
+    if (node.width > 0)
+      break;
+
+    skyline.erase(skyline.begin() + i);
+    i--;
+  }
+
+  // Merge neighbours at the same height
+  for (size_t i = 0; i + 1 < skyline.size();) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+}
+
+auto SkylinePacker::pack(int w, int h, int &out_x, int &out_y) -> bool {
+  int best_bottom = INT_MAX;
+  int best_width = INT_MAX;
+  int best_x = 0;
+  int best_y = 0;
+  size_t best_index = SIZE_MAX;
+
+  for (size_t i = 0; i < skyline.size(); i++) {
+    int y = fits(i, w, h);
+    if (y < 0)
+      continue;
+
+    if (y + h < best_bottom ||
+        (y + h == best_bottom && skyline[i].width < best_width)) {
+      best_bottom = y + h;
+      best_width = skyline[i].width;
+      best_index = i;
+      best_x = skyline[i].x;
+      best_y = y;
+    }
+  }
+
+  if (best_index == SIZE_MAX)
+    return false;
+
+  add_level(best_index, best_x, best_y, w, h);
+  out_x = best_x;
+  out_y = best_y;
+  return true;
+}
+
+void TextureAtlas::init(int size) { page_size = size; }
+
+auto TextureAtlas::new_page() -> Page & {
+  Page page = {.packer = SkylinePacker(page_size, page_size),
+               .pixels = std::vector<uint8_t>(page_size * page_size * 4, 0),
+               .live_regions = 0,
+               .dirty = true,
+               .reset_pending = false,
+               .emptied_upload = 0};
+
+  sg_image_desc image_desc = {.usage = {.dynamic_update = true},
+                              .width = page_size,
+                              .height = page_size,
+                              .pixel_format = SG_PIXELFORMAT_RGBA8};
+  page.texture.image = sg_make_image(image_desc);
+  page.texture.view = sg_alloc_view();
+  sg_init_view(page.texture.view, {.texture = {.image = page.texture.image}});
+
+  spdlog::info("atlas: created page {} ({}x{})", pages.size(), page_size,
+               page_size);
+  pages.push_back(std::move(page));
+  return pages.back();
+}
+
+auto TextureAtlas::add(const uint8_t *pixels, int width, int height)
+    -> GpuTexture {
+  int padded_w = width + PADDING * 2;
+  int padded_h = height + PADDING * 2;
+
+  if (padded_w > page_size || padded_h > page_size) {
+    size_t bytes = (size_t)width * height * 4;
+    sg_image_desc image_desc = {
+        .width = width,
+        .height = height,
+        .pixel_format = SG_PIXELFORMAT_RGBA8,
+        .data = {.mip_levels = {{.ptr = pixels, .size = bytes}}}};
+    return add_standalone(image_desc, bytes);
+  }
+
+  int x = 0, y = 0;
+  Page *page = nullptr;
+  for (auto &candidate : pages) {
+    if (candidate.packer.pack(padded_w, padded_h, x, y)) {
+      page = &candidate;
+      break;
+    }
+  }
+
+  if (!page) {
+    page = &new_page();
+    page->packer.pack(padded_w, padded_h, x, y);
+  }
+  return place(*page, x, y, pixels, width, height);
+}
+
+auto TextureAtlas::add_to_dirty_page(const uint8_t *pixels, int width,
+                                     int height, GpuTexture &out) -> bool {
+  int x = 0, y = 0;
+  for (auto &page : pages) {
+    if (page.dirty &&
+        page.packer.pack(width + PADDING * 2, height + PADDING * 2, x, y)) {
+      out = place(page, x, y, pixels, width, height);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Copies the pixels into the packed rectangle at (x, y) and counts the region
+auto TextureAtlas::place(Page &page, int x, int y, const uint8_t *pixels,
+                         int width, int height) -> GpuTexture {
+  // Copy with the border pixels extruded into the padding
+  for (int row = -PADDING; row < height + PADDING; row++) {
+    int src_row = std::clamp(row, 0, height - 1);
+    uint8_t *dst = page.pixels.data() +
+                   ((size_t)(y + PADDING + row) * page_size + x) * 4;
+    const uint8_t *src = pixels + (size_t)src_row * width * 4;
+    for (int col = -PADDING; col < width + PADDING; col++) {
+      int src_col = std::clamp(col, 0, width - 1);
+      std::memcpy(dst, src + src_col * 4, 4);
+      dst += 4;
+    }
+  }
+  page.live_regions++;
+  page.dirty = true;
+
+  float size = (float)page_size;
+  GpuTexture texture = page.texture;
+  texture.uv = {(x + PADDING) / size, (y + PADDING) / size,
+                (x + PADDING + width) / size, (y + PADDING + height) / size};
+  return texture;
+}
+
+auto TextureAtlas::add_pinned(const uint8_t *pixels, int width, int height)
+    -> GpuTexture {
+  auto texture = add(pixels, width, height);
+  for (auto &page : pages) {
+    if (page.texture.image.id != texture.image.id)
+      continue;
+
+    // Earlier regions would be pinned with it and leak
+    assert(page.live_regions == 1 && "pinned regions must come first");
+    page.packer.pin();
+    page.live_regions--;
+  }
+  return texture;
+}
+
+auto TextureAtlas::add_standalone(const sg_image_desc &desc, size_t bytes)
+    -> GpuTexture {
+  GpuTexture texture = {};
+  texture.image = sg_make_image(desc);
+  texture.view = sg_alloc_view();
+  sg_init_view(texture.view, {.texture = {.image = texture.image}});
+  standalone_sizes[texture.image.id] = bytes;
+  standalone_bytes += bytes;
+  new_standalone_bytes += bytes;
+  return texture;
+}
+
+void TextureAtlas::release(const GpuTexture &texture) {
+  for (auto &page : pages) {
+    if (page.texture.image.id != texture.image.id)
+      continue;
+
+    if (--page.live_regions == 0) {
+      page.reset_pending = true;
+      page.emptied_upload = uploads;
+    }
+    return;
+  }
+
+  auto it = standalone_sizes.find(texture.image.id);
+  if (it == standalone_sizes.end())
+    return;
+
+  standalone_bytes -= it->second;
+  standalone_sizes.erase(it);
+  retired.push_back({texture, uploads});
+}
+
+auto TextureAtlas::get_resident_bytes() const -> size_t {
+  return pages.size() * page_size * page_size * 4 + standalone_bytes;
+}
+
+auto TextureAtlas::get_upload_bytes() const -> size_t {
+  size_t bytes = new_standalone_bytes;
+  for (auto &page : pages) {
+    if (page.dirty)
+      bytes += page.pixels.size();
+  }
+  return bytes;
+}
+
+void TextureAtlas::upload() {
+  uploads++;
+  new_standalone_bytes = 0;
+  std::erase_if(retired, [this](const Retired &entry) {
+    if (uploads - entry.upload < RETIRE_AFTER_UPLOADS)
+      return false;
+    sg_destroy_view(entry.texture.view);
+    sg_destroy_image(entry.texture.image);
+    return true;
+  });
+
+  for (auto &page : pages) {
+    // New regions went into free space meanwhile, so the page stays packed
+    if (page.reset_pending && page.live_regions > 0)
+      page.reset_pending = false;
+    if (page.reset_pending &&
+        uploads - page.emptied_upload >= RETIRE_AFTER_UPLOADS) {
+      page.packer.reset();
+      page.reset_pending = false;
+    }
+
+    if (!page.dirty)
+      continue;
+
+    sg_image_data data = {};
+    data.mip_levels[0] = {.ptr = page.pixels.data(),
+                          .size = page.pixels.size()};
+    sg_update_image(page.texture.image, data);
+    page.dirty = false;
+  }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "sokol_gfx.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct GpuTexture {
+  sg_view view;
+  sg_image image;
+  // Region of the image covered by this texture as (u0, v0, u1, v1).
+  glm::vec4 uv = {0.0f, 0.0f, 1.0f, 1.0f};
+};
+
+// Bottom-left skyline rectangle packer. Pure CPU so it can be used without a
+// graphics context.
+class SkylinePacker {
+private:
+  struct Node {
+    int x;
+    int y;
+    int width;
+  };
+
+  int width = 0;
+  int height = 0;
+  std::vector<Node> skyline;
+  // What reset goes back to, empty unless pinned
+  std::vector<Node> pinned;
+
+  auto fits(size_t index, int w, int h) const -> int;
+  void add_level(size_t index, int x, int y, int w, int h);
+
+public:
+  SkylinePacker() = default;
+  SkylinePacker(int width, int height);
+
+  auto pack(int w, int h, int &out_x, int &out_y) -> bool;
+  void reset();
+  // Keeps everything packed so far across resets.
+  void pin();
+};
+
+// Packs RGBA8 images into shared pages so sprites with different source files
+// can be drawn in the same batch.
+class TextureAtlas {
+private:
+  struct Page {
+    SkylinePacker packer;
+    std::vector<uint8_t> pixels;
+    GpuTexture texture;
+    // Regions handed out and not yet released. A page whose count drops to
+    // zero is repacked from scratch, once frames in flight are done with it.
+    int live_regions;
+    bool dirty;
+    bool reset_pending;
+    uint64_t emptied_upload;
+  };
+
+  // Border extruded around every region to avoid bleeding when filtering.
+  static constexpr int PADDING = 1;
+
+  std::vector<Page> pages;
+  int page_size = 2048;
+  // Bytes of each standalone image, keyed by image id
+  std::unordered_map<uint32_t, size_t> standalone_sizes;
+  size_t standalone_bytes = 0;
+  // Standalone bytes created since the last upload
+  size_t new_standalone_bytes = 0;
+
+  // Released standalone images wait for the frames still drawing them
+  struct Retired {
+    GpuTexture texture;
+    uint64_t upload;
+  };
+  static constexpr uint64_t RETIRE_AFTER_UPLOADS = 2;
+  std::vector<Retired> retired;
+  uint64_t uploads = 0;
+
+  auto new_page() -> Page &;
+  auto place(Page &page, int x, int y, const uint8_t *pixels, int width,
+             int height) -> GpuTexture;
+
+public:
+  void init(int page_size);
+
+  // Copies the pixels into a page, or into a standalone image if they do not
+  // fit in one. The caller keeps ownership of `pixels`.
+  auto add(const uint8_t *pixels, int width, int height) -> GpuTexture;
+
+  // Like add, but only into a page already due for upload, so it costs the
+  // next upload nothing. Returns false if none has room.
+  auto add_to_dirty_page(const uint8_t *pixels, int width, int height,
+                         GpuTexture &out) -> bool;
+
+  // Adds a region that is never released and does not keep its page from
+  // being repacked. Must come before any add on that page.
+  auto add_pinned(const uint8_t *pixels, int width, int height) -> GpuTexture;
+
+  // Creates an image outside the pages, for textures that are too big or
+  // carry their own mip chain. `bytes` is counted as resident.
+  auto add_standalone(const sg_image_desc &desc, size_t bytes) -> GpuTexture;
+
+  // Gives back a texture returned by add or add_standalone. Page space is
+  // reclaimed once every region on the page has been released, and like
+  // standalone images only when frames in flight can no longer use it.
+  void release(const GpuTexture &texture);
+
+  // GPU memory held by pages and standalone images.
+  auto get_resident_bytes() const -> size_t;
+
+  // Bytes the next upload sends. sokol updates an image whole, so a dirty
+  // page counts in full however little of it changed.
+  auto get_upload_bytes() const -> size_t;
+
+  // Uploads modified pages and destroys retired images. Must be called once
+  // per frame.
+  void upload();
+};
@@ -0,0 +1,162 @@
+#include "cooked_texture.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+void premultiply_alpha(uint8_t *rgba, size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; i++) {
+    uint8_t *p = rgba + i * 4;
+    uint32_t a = p[3];
+    p[0] = (uint8_t)((p[0] * a + 127) / 255);
+    p[1] = (uint8_t)((p[1] * a + 127) / 255);
+    p[2] = (uint8_t)((p[2] * a + 127) / 255);
+  }
+}
+
+auto cooked_texture_path(const std::string &source_path) -> std::string {
+  auto dot = source_path.find_last_of('.');
+  auto slash = source_path.find_last_of("/\\");
+  if (dot == std::string::npos ||
+      (slash != std::string::npos && dot < slash))
+    return source_path + ".ctex";
+  return source_path.substr(0, dot) + ".ctex";
+}
+
+// 2x2 box filter; odd edges reuse the last row or column. Filtering
+// premultiplied pixels keeps transparent texels from darkening the result.
+static void downsample(const uint8_t *src, int src_w, int src_h, uint8_t *dst,
+                       int dst_w, int dst_h) {
+  for (int y = 0; y < dst_h; y++) {
+    int y0 = std::min(y * 2, src_h - 1);
+    int y1 = std::min(y * 2 + 1, src_h - 1);
+    for (int x = 0; x < dst_w; x++) {
+      int x0 = std::min(x * 2, src_w - 1);
+      int x1 = std::min(x * 2 + 1, src_w - 1);
+      for (int c = 0; c < 4; c++) {
+        uint32_t sum = src[((size_t)y0 * src_w + x0) * 4 + c] +
+                       src[((size_t)y0 * src_w + x1) * 4 + c] +
+                       src[((size_t)y1 * src_w + x0) * 4 + c] +
+                       src[((size_t)y1 * src_w + x1) * 4 + c];
+        dst[((size_t)y * dst_w + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+static auto align16(uint64_t offset) -> uint64_t {
+  return (offset + 15) & ~(uint64_t)15;
+}
+
+auto cook_texture(const uint8_t *rgba, int width, int height,
+                  const char *out_path) -> bool {
+  std::vector<std::vector<uint8_t>> levels;
+  std::vector<CookedMip> mips;
+
+  levels.emplace_back(rgba, rgba + (size_t)width * height * 4);
+  premultiply_alpha(levels[0].data(), (size_t)width * height);
+  mips.push_back({.width = (uint32_t)width, .height = (uint32_t)height});
+
+  bool mipmapped = std::max(width, height) >= COOKED_MIPMAP_MIN_SIZE;
+  while (mipmapped && (mips.back().width > 1 || mips.back().height > 1) &&
+         mips.size() < MAX_COOKED_MIPS) {
+    auto &prev = mips.back();
+    uint32_t w = std::max(prev.width / 2, 1u);
+    uint32_t h = std::max(prev.height / 2, 1u);
+    std::vector<uint8_t> level((size_t)w * h * 4);
+    downsample(levels.back().data(), prev.width, prev.height, level.data(), w,
+               h);
+    levels.push_back(std::move(level));
+    mips.push_back({.width = w, .height = h});
+  }
+
+  uint64_t offset =
+      align16(sizeof(CookedTextureHeader) + mips.size() * sizeof(CookedMip));
+  for (size_t i = 0; i < mips.size(); i++) {
+    mips[i].offset = offset;
+    mips[i].size = levels[i].size();
+    offset = align16(offset + mips[i].size);
+  }
+
+  CookedTextureHeader header = {.magic = {'L', 'X', 'T', 'X'},
+                                .version = COOKED_TEXTURE_VERSION,
+                                .width = (uint32_t)width,
+                                .height = (uint32_t)height,
+                                .mip_count = (uint32_t)mips.size(),
+                                .flags = COOKED_PREMULTIPLIED |
+                                         (mipmapped ? COOKED_MIPMAPPED : 0)};
+
+  FILE *f = fopen(out_path, "wb");
+  if (!f) {
+    spdlog::error("Could not write cooked texture {}", out_path);
+    return false;
+  }
+
+  std::vector<uint8_t> blob(offset, 0);
+  std::memcpy(blob.data(), &header, sizeof(header));
+  std::memcpy(blob.data() + sizeof(header), mips.data(),
+              mips.size() * sizeof(CookedMip));
+  for (size_t i = 0; i < mips.size(); i++) {
+    std::memcpy(blob.data() + mips[i].offset, levels[i].data(),
+                levels[i].size());
+  }
+
+  bool ok = fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+  fclose(f);
+  return ok;
+}
+
+auto CookedTexture::open(VfsFile &&source, const std::string &path) -> bool {
+  auto bytes = source.data();
+  size_t size = bytes.size();
+  if (size < sizeof(CookedTextureHeader))
+    return false;
+
+  auto data = (const uint8_t *)bytes.data();
+  auto candidate = (const CookedTextureHeader *)data;
+  auto candidate_mips =
+      (const CookedMip *)(data + sizeof(CookedTextureHeader));
+  bool valid = std::memcmp(candidate->magic, "LXTX", 4) == 0 &&
+               candidate->version == COOKED_TEXTURE_VERSION &&
+               candidate->mip_count > 0 &&
+               candidate->mip_count <= MAX_COOKED_MIPS &&
+               sizeof(CookedTextureHeader) +
+                       candidate->mip_count * sizeof(CookedMip) <=
+                   size;
+  // Callers size the base level from the header, so it has to agree
+  valid = valid && candidate_mips[0].width == candidate->width &&
+          candidate_mips[0].height == candidate->height;
+  for (uint32_t i = 0; valid && i < candidate->mip_count; i++) {
+    auto &mip = candidate_mips[i];
+    valid = mip.offset <= size && mip.size <= size - mip.offset &&
+            mip.size == (uint64_t)mip.width * mip.height * 4;
+  }
+
+  if (!valid) {
+    spdlog::error("Invalid or outdated cooked texture {}", path);
+    return false;
+  }
+
+  file = std::move(source);
+  base = data;
+  header = candidate;
+  mips = candidate_mips;
+  return true;
+}
+
+void CookedTexture::prefetch() const {
+  volatile uint8_t sink = 0;
+  size_t size = file.data().size();
+  for (size_t i = 0; i < size; i += 4096) {
+    sink = sink + base[i];
+  }
+}
+
+auto CookedTexture::get_byte_size() const -> size_t {
+  size_t bytes = 0;
+  for (int i = 0; i < get_mip_count(); i++) {
+    bytes += mips[i].size;
+  }
+  return bytes;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "vfs.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Cooked texture file (.ctex): premultiplied RGBA8, laid out so each level can
+// be handed to the GPU straight from a mapping. Sprites carry only the base
+// level and are packed into the atlas like decoded images; big textures keep
+// their full mip chain and get an image of their own.
+//
+//   CookedTextureHeader
+//   CookedMip[mip_count]
+//   level data, each level 16-byte aligned
+struct CookedTextureHeader {
+  char magic[4]; // "LXTX"
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t mip_count;
+  uint32_t flags;
+};
+
+struct CookedMip {
+  uint64_t offset; // from the start of the file
+  uint64_t size;
+  uint32_t width;
+  uint32_t height;
+};
+
+static constexpr uint32_t COOKED_TEXTURE_VERSION = 2;
+static constexpr uint32_t COOKED_PREMULTIPLIED = 1 << 0;
+// Has a mip chain and is loaded outside the atlas
+static constexpr uint32_t COOKED_MIPMAPPED = 1 << 1;
+static constexpr int MAX_COOKED_MIPS = 16;
+// Images this big in either dimension are cooked with mips
+static constexpr int COOKED_MIPMAP_MIN_SIZE = 1024;
+
+// Multiplies color by alpha in place.
+void premultiply_alpha(uint8_t *rgba, size_t pixel_count);
+
+// Path of the cooked file for a source image: the extension becomes .ctex.
+auto cooked_texture_path(const std::string &source_path) -> std::string;
+
+// Premultiplies `rgba`, builds the mip chain if the image is big enough and
+// writes a .ctex file.
+auto cook_texture(const uint8_t *rgba, int width, int height,
+                  const char *out_path) -> bool;
+
+// A mapped .ctex file. Level pointers stay valid while it is open.
+class CookedTexture {
+private:
+  VfsFile file;
+  const uint8_t *base = nullptr;
+  const CookedTextureHeader *header = nullptr;
+  const CookedMip *mips = nullptr;
+
+public:
+  // Takes the file over if it is a valid .ctex. `path` is only used to report
+  // errors.
+  auto open(VfsFile &&source, const std::string &path) -> bool;
+
+  auto get_width() const -> int { return header->width; }
+  auto get_height() const -> int { return header->height; }
+  auto get_mip_count() const -> int { return header->mip_count; }
+  auto is_mipmapped() const -> bool {
+    return (header->flags & COOKED_MIPMAPPED) != 0;
+  }
+  auto get_mip(int level) const -> const CookedMip & { return mips[level]; }
+  auto get_mip_data(int level) const -> const uint8_t * {
+    return base + mips[level].offset;
+  }
+
+  // Bytes of every level together.
+  auto get_byte_size() const -> size_t;
+
+  // Touches every page of the mapping so later reads do not fault.
+  void prefetch() const;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// Two-slot handoff between the thread that captures frames and a worker that
+// prepares them. The capturing thread fills one slot while the worker prepares
+// the other, and only waits when the worker is still on a frame it captured
+// two frames ago. Slot ownership moves through atomic states, so no locks are
+// taken.
+template <typename T> class FramePipeline {
+private:
+  enum State : uint32_t { FREE, CAPTURED, PREPARED, STOPPED };
+
+  struct Slot {
+    T value;
+    std::atomic<uint32_t> state = FREE;
+  };
+
+  Slot slots[2];
+  uint32_t capture_index = 0; // capturing thread only
+  uint32_t submit_index = 0;  // capturing thread only
+  std::function<void(T &)> prepare;
+  std::thread worker;
+
+  static void wait_for(Slot &slot, uint32_t wanted) {
+    uint32_t state;
+    while ((state = slot.state.load(std::memory_order_acquire)) != wanted) {
+      slot.state.wait(state, std::memory_order_acquire);
+    }
+  }
+
+  void work() {
+    uint32_t index = 0;
+    while (true) {
+      auto &slot = slots[index];
+      uint32_t state;
+      while ((state = slot.state.load(std::memory_order_acquire)) !=
+             CAPTURED) {
+        if (state == STOPPED)
+          return;
+        slot.state.wait(state, std::memory_order_acquire);
+      }
+
+      prepare(slot.value);
+      slot.state.store(PREPARED, std::memory_order_release);
+      slot.state.notify_all();
+      index ^= 1;
+    }
+  }
+
+public:
+  ~FramePipeline() { stop(); }
+
+  void start(std::function<void(T &)> prepare_frame) {
+    prepare = std::move(prepare_frame);
+    worker = std::thread(&FramePipeline::work, this);
+  }
+
+  void stop() {
+    if (!worker.joinable())
+      return;
+
+    for (auto &slot : slots) {
+      slot.state.store(STOPPED, std::memory_order_release);
+      slot.state.notify_all();
+    }
+    worker.join();
+  }
+
+  // Slot to fill for the next frame. Hand it over with end_capture.
+  auto begin_capture() -> T & {
+    auto &slot = slots[capture_index];
+    wait_for(slot, FREE);
+    return slot.value;
+  }
+
+  void end_capture() {
+    auto &slot = slots[capture_index];
+    slot.state.store(CAPTURED, std::memory_order_release);
+    slot.state.notify_all();
+    capture_index ^= 1;
+  }
+
+  // Oldest captured frame once the worker is done with it, or nullptr if
+  // nothing was captured. Give it back with release.
+  auto acquire_prepared() -> T * {
+    auto &slot = slots[submit_index];
+    if (slot.state.load(std::memory_order_acquire) == FREE)
+      return nullptr;
+
+    wait_for(slot, PREPARED);
+    return &slot.value;
+  }
+
+  void release() {
+    auto &slot = slots[submit_index];
+    slot.state.store(FREE, std::memory_order_release);
+    slot.state.notify_all();
+    submit_index ^= 1;
+  }
+};
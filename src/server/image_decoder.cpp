@@ -0,0 +1,102 @@
+#include "image_decoder.hpp"
+#include "spdlog/spdlog.h"
+#include "stb_image.h"
+#include <algorithm>
+
+ImageDecoder::~ImageDecoder() { shutdown(); }
+
+void ImageDecoder::init(int worker_count, const Vfs &files) {
+  vfs = &files;
+  for (int i = 0; i < worker_count; i++) {
+    workers.emplace_back(&ImageDecoder::work, this);
+  }
+}
+
+void ImageDecoder::shutdown() {
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+
+  for (auto &image : finished) {
+    free_image(image);
+  }
+  finished.clear();
+}
+
+void ImageDecoder::push(const std::string &path, uint32_t id) {
+  {
+    std::lock_guard lock(mutex);
+    jobs.push_back({.path = path, .id = id});
+  }
+  wake.notify_one();
+}
+
+void ImageDecoder::work() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock(mutex);
+      wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (stopping)
+        return;
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    Image image = {.path = std::move(job.path), .id = job.id};
+    auto cooked = std::make_unique<CookedTexture>();
+    auto cooked_path = cooked_texture_path(image.path);
+    auto cooked_file = vfs->open(cooked_path);
+    if (cooked_file.is_valid() &&
+        cooked->open(std::move(cooked_file), cooked_path)) {
+      // Fault the mapping in here rather than on the render thread
+      cooked->prefetch();
+      image.width = cooked->get_width();
+      image.height = cooked->get_height();
+      image.cooked = std::move(cooked);
+    } else {
+      auto file = vfs->open(image.path);
+      auto bytes = file.data();
+      int channels;
+      image.pixels = file.is_valid()
+                         ? stbi_load_from_memory(
+                               (const stbi_uc *)bytes.data(), (int)bytes.size(),
+                               &image.width, &image.height, &channels, 4)
+                         : nullptr;
+      if (image.pixels) {
+        premultiply_alpha(image.pixels, (size_t)image.width * image.height);
+      } else {
+        spdlog::error("Could not load image {}: {}", image.path,
+                      file.is_valid() ? stbi_failure_reason() : "not found");
+        image.width = 0;
+        image.height = 0;
+      }
+    }
+
+    std::lock_guard lock(mutex);
+    finished.push_back(std::move(image));
+  }
+}
+
+void ImageDecoder::pop_finished(std::vector<Image> &out, size_t byte_budget) {
+  std::lock_guard lock(mutex);
+  size_t bytes = 0;
+  while (!finished.empty() && bytes < byte_budget) {
+    bytes += std::max<size_t>(finished.front().byte_size(), 1);
+    out.push_back(std::move(finished.front()));
+    finished.pop_front();
+  }
+}
+
+void ImageDecoder::free_image(Image &image) {
+  if (image.pixels)
+    stbi_image_free(image.pixels);
+  image.pixels = nullptr;
+  image.cooked.reset();
+}
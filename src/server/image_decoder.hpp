@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include "cooked_texture.hpp"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads images on worker threads as premultiplied RGBA8. A cooked .ctex next
+// to the requested file is mapped instead of decoding it. Finished images are
+// picked up by the render thread, which owns every GPU call.
+class ImageDecoder {
+public:
+  struct Job {
+    std::string path;
+    uint32_t id;
+  };
+
+  struct Image {
+    std::string path;
+    uint32_t id;
+    uint8_t *pixels; // decoded source, nullptr if cooked or failed
+    std::unique_ptr<CookedTexture> cooked;
+    int width;
+    int height;
+
+    auto byte_size() const -> size_t {
+      return cooked ? cooked->get_byte_size() : (size_t)width * height * 4;
+    }
+  };
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Job> jobs;
+  std::deque<Image> finished;
+  bool stopping = false;
+  const Vfs *vfs = nullptr;
+
+  void work();
+
+public:
+  ~ImageDecoder();
+
+  void init(int worker_count, const Vfs &vfs);
+  void shutdown();
+
+  // `id` is passed back with the decoded image.
+  void push(const std::string &path, uint32_t id);
+
+  // Moves finished images into `out` until their pixels add up to
+  // `byte_budget`. The last image may overshoot, so big files still get
+  // through.
+  void pop_finished(std::vector<Image> &out, size_t byte_budget);
+
+  static void free_image(Image &image);
+};
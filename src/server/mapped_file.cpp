@@ -0,0 +1,84 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+#if defined(_WIN32)
+
+auto MappedFile::open(const char *path) -> bool {
+  close();
+  file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    file = nullptr;
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file, &file_size);
+  length = (size_t)file_size.QuadPart;
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping)
+    bytes = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (!bytes) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::close() {
+  if (bytes)
+    UnmapViewOfFile(bytes);
+  if (mapping)
+    CloseHandle(mapping);
+  if (file)
+    CloseHandle(file);
+  bytes = nullptr;
+  mapping = nullptr;
+  file = nullptr;
+  length = 0;
+}
+
+#else
+
+auto MappedFile::open(const char *path) -> bool {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  bytes = (const uint8_t *)mapped;
+  length = info.st_size;
+  return true;
+}
+
+void MappedFile::close() {
+  if (bytes)
+    munmap((void *)bytes, length);
+  bytes = nullptr;
+  length = 0;
+}
+
+#endif
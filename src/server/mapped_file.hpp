@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+private:
+  const uint8_t *bytes = nullptr;
+  size_t length = 0;
+#if defined(_WIN32)
+  void *file = nullptr;
+  void *mapping = nullptr;
+#endif
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  auto open(const char *path) -> bool;
+  void close();
+
+  auto data() const -> const uint8_t * { return bytes; }
+  auto size() const -> size_t { return length; }
+};
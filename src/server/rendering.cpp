@@ -1,19 +1,10 @@
 #include "rendering.hpp"
 #include "../luxlib.hpp"
 #include "spdlog/spdlog.h"
+#include <algorithm>
+#include <thread>
 #include <vector>
 
-HandleId RenderingServer::get_next_id() {
-  if (!free_ids.empty()) {
-    HandleId id = free_ids.back();
-    free_ids.pop_back();
-    return id;
-  }
-
-  HandleId id = {next_id};
-  next_id += 1;
-  return id;
-}
 void RenderingServer::set_camera_zoom(float zoom) {
   camera.zoom = zoom;
   camera.update_mats();
@@ -24,31 +15,268 @@ void RenderingServer::set_camera_position(vec3 position) {
   camera.update_mats();
 }
 
+// LSD radix sort of whole keys. Passes where every key shares the same byte are
+// skipped, which is the common case for layers and pipelines.
+static void radix_sort_keys(std::vector<uint64_t> &keys,
+                            std::vector<uint64_t> &scratch) {
+  constexpr int FIRST_BYTE = 0;
+  constexpr int BYTES = 8;
+  uint32_t histograms[BYTES][256] = {};
+  for (auto key : keys) {
+    for (int b = 0; b < BYTES; b++) {
+      histograms[b][(key >> ((FIRST_BYTE + b) * 8)) & 0xFF]++;
+    }
+  }
+
+  scratch.resize(keys.size());
+  for (int b = 0; b < BYTES; b++) {
+    auto &histogram = histograms[b];
+    int shift = (FIRST_BYTE + b) * 8;
+    if (histogram[(keys.front() >> shift) & 0xFF] == keys.size())
+      continue;
+
+    uint32_t offset = 0;
+    for (auto &count : histogram) {
+      uint32_t next = offset + count;
+      count = offset;
+      offset = next;
+    }
+
+    for (auto key : keys) {
+      scratch[histogram[(key >> shift) & 0xFF]++] = key;
+    }
+    keys.swap(scratch);
+  }
+}
+
+auto RenderingServer::make_sort_key(const Visual2 &visual, HandleId id)
+    -> uint64_t {
+  // sg ids keep the pool slot in the low 16 bits, unique among live views.
+  uint64_t view_slot = visual.texture.view.id & 0xFFFF;
+  return ((uint64_t)visual.layer << 56) | ((uint64_t)SPRITE_PIPELINE << 48) |
+         (view_slot << 32) | id;
+}
+
+void RenderingServer::rebuild_sorted_visuals() {
+  sorted_visuals.clear();
+  for (size_t i = 0; i < visuals.size(); i++) {
+    auto &visual = visuals.data()[i];
+    if (!visual.is_static)
+      sorted_visuals.push_back(make_sort_key(visual, visuals.handle_at(i)));
+  }
+
+  // The handle bits are sorted too, so overlapping sprites keep their order
+  if (!sorted_visuals.empty())
+    radix_sort_keys(sorted_visuals, draw_list_scratch);
+  sorted_visuals_dirty = false;
+}
+
+void RenderingServer::build_draw_list() {
+  if (sorted_visuals_dirty)
+    rebuild_sorted_visuals();
+
+  visible_visuals.clear();
+  visual_grid.query(camera.bounds.min, camera.bounds.max, visible_visuals);
+  for (auto id : visible_visuals) {
+    auto index = handle_index(id);
+    if (index >= visible_marks.size())
+      visible_marks.resize(index + 1, 0);
+    visible_marks[index] = 1;
+  }
+
+  // Filtering keeps the sorted order without sorting the visible set again
+  draw_list.clear();
+  for (auto key : sorted_visuals) {
+    auto index = handle_index((HandleId)key);
+    if (index < visible_marks.size() && visible_marks[index])
+      draw_list.push_back(key);
+  }
+
+  for (auto id : visible_visuals) {
+    visible_marks[handle_index(id)] = 0;
+  }
+}
+
+void RenderingServer::rebuild_static_layer() {
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < visuals.size(); i++) {
+    auto &visual = visuals.data()[i];
+    if (visual.is_static)
+      keys.push_back(make_sort_key(visual, visuals.handle_at(i)));
+  }
+  if (!keys.empty())
+    radix_sort_keys(keys, draw_list_scratch);
+
+  std::vector<GpuInstance2> instances;
+  static_batches.clear();
+  for (auto key : keys) {
+    auto visual = visuals.get((HandleId)key);
+    if (!visual || visual->texture.view.id == 0)
+      continue;
+
+    if (static_batches.empty() ||
+        static_batches.back().view.id != visual->texture.view.id ||
+        static_batches.back().layer != visual->layer)
+      static_batches.push_back({visual->texture.view,
+                                (uint32_t)instances.size(), 0, visual->layer});
+    instances.push_back(make_instance(*visual));
+    static_batches.back().count++;
+  }
+
+  // The last frame using the old buffer has already been submitted
+  if (static_buffer.id != SG_INVALID_ID)
+    sg_destroy_buffer(static_buffer);
+  static_buffer = {};
+  if (!instances.empty()) {
+    sg_buffer_desc desc = {
+        .data = {.ptr = instances.data(),
+                 .size = instances.size() * sizeof(GpuInstance2)},
+        .label = "static sprites"};
+    static_buffer = sg_make_buffer(&desc);
+  }
+
+  spdlog::info("Rebuilt static layer: {} sprites in {} batches",
+               instances.size(), static_batches.size());
+  static_dirty = false;
+}
+
+static auto same_region(const GpuTexture &a, const GpuTexture &b) -> bool {
+  return a.view.id == b.view.id && a.uv == b.uv;
+}
+
 HandleId RenderingServer::new_visual2() {
-  HandleId id = get_next_id();
-  Visual2 visual = {};
-  visuals.insert({id, visual});
+  auto id = visuals.insert();
+  auto bounds = visual_bounds(*visuals.get(id));
+  visual_grid.update(id, bounds.min, bounds.max);
+  sorted_visuals_dirty = true;
   return id;
 }
 
-Visual2 &RenderingServer::get_visual2(const HandleId &id) {
-  return visuals[id];
+Visual2 *RenderingServer::get_visual2(const HandleId &id) {
+  return visuals.get(id);
 }
 
 void RenderingServer::delete_visual2(const HandleId &id) {
+  auto visual = visuals.get(id);
+  if (!visual) {
+    spdlog::warn("Trying to delete a stale visual handle {}.", id);
+    return;
+  }
+
+  release_texture(visual->texture_id);
+  if (visual->is_static)
+    static_dirty = true;
+  visual_grid.remove(id);
   visuals.erase(id);
-  free_ids.push_back(id);
+  sorted_visuals_dirty = true;
+}
+
+void RenderingServer::set_visual2_texture(const HandleId &id,
+                                          TextureId texture) {
+  auto visual = visuals.get(id);
+  if (!visual || visual->texture_id == texture)
+    return;
+
+  acquire_texture(texture);
+  release_texture(visual->texture_id);
+  visual->texture_id = texture;
+
+  auto &resolved = resolve_texture(texture);
+  // Atlas regions share a view, so only a view change affects the sort key
+  if (visual->texture.view.id != resolved.view.id)
+    sorted_visuals_dirty = true;
+  if (visual->is_static && !same_region(visual->texture, resolved))
+    static_dirty = true;
+  visual->texture = resolved;
 }
 
-void RenderingServer::init() {
+void RenderingServer::set_visual2_texture(const HandleId &id,
+                                          const GpuTexture &texture) {
+  auto visual = visuals.get(id);
+  if (!visual)
+    return;
+
+  release_texture(visual->texture_id);
+  visual->texture_id = 0;
+
+  if (visual->texture.view.id != texture.view.id)
+    sorted_visuals_dirty = true;
+  if (visual->is_static && !same_region(visual->texture, texture))
+    static_dirty = true;
+  visual->texture = texture;
+}
+
+void RenderingServer::set_visual2_layer(const HandleId &id, uint8_t layer) {
+  auto visual = visuals.get(id);
+  if (!visual || visual->layer == layer)
+    return;
+
+  visual->layer = layer;
+  sorted_visuals_dirty = true;
+  if (visual->is_static)
+    static_dirty = true;
+}
+
+void RenderingServer::set_visual2_model(const HandleId &id,
+                                        const Affine2 &model) {
+  auto visual = visuals.get(id);
+  if (!visual)
+    return;
+
+  if (visual->is_static && visual->model != model)
+    static_dirty = true;
+  visual->model = model;
+  update_grid(id, *visual);
+}
+
+void RenderingServer::set_visual2_size(const HandleId &id, vec2 size) {
+  auto visual = visuals.get(id);
+  if (!visual)
+    return;
+
+  if (visual->is_static && visual->size != size)
+    static_dirty = true;
+  visual->size = size;
+  update_grid(id, *visual);
+}
+
+void RenderingServer::set_visual2_static(const HandleId &id, bool is_static) {
+  auto visual = visuals.get(id);
+  if (!visual || visual->is_static == is_static)
+    return;
+
+  visual->is_static = is_static;
+  static_dirty = true;
+  sorted_visuals_dirty = true;
+  update_grid(id, *visual);
+}
+
+auto RenderingServer::visual_bounds(const Visual2 &visual) -> Bounds2 {
+  vec2 center = visual.model.origin;
+  vec2 half_x = visual.model.x_axis * visual.size.x * 0.5f;
+  vec2 half_y = visual.model.y_axis * visual.size.y * 0.5f;
+  vec2 extent = glm::abs(half_x) + glm::abs(half_y);
+  return {.min = center - extent, .max = center + extent};
+}
+
+// Static visuals are drawn from the static layer, so only dynamic ones are
+// culled through the grid.
+void RenderingServer::update_grid(const HandleId &id, const Visual2 &visual) {
+  if (visual.is_static) {
+    visual_grid.remove(id);
+    return;
+  }
+
+  auto bounds = visual_bounds(visual);
+  visual_grid.update(id, bounds.min, bounds.max);
+}
+
+void RenderingServer::init(const Vfs &vfs) {
   sg_shader shader = sg_make_shader(unlit2_shader_desc(sg_query_backend()));
 
-  // Create a dynamic vertex buffer
-  sg_buffer_desc vbo_desc = {.size = MAX_VERTICES * sizeof(GpuVertex2) *
-                                     MAX_BATCHES,
-                             .usage = {.dynamic_update = true}};
-  vbo = sg_make_buffer(&vbo_desc);
-  current_view = sg_alloc_view();
+  // Create the streaming vertex buffer
+  vertex_stream.init(MAX_VERTICES * sizeof(GpuVertex2) * MAX_BATCHES,
+                     "sprite vertices");
 
   // Create static index buffer for quads
   const int MAX_INDICES = (MAX_VERTICES / 4) * 6;
@@ -70,26 +298,96 @@ void RenderingServer::init() {
   ibo = sg_make_buffer(&buffer_desc);
 
   sg_sampler_desc sampler_desc = {.min_filter = SG_FILTER_LINEAR,
-                                  .mag_filter = SG_FILTER_LINEAR};
-  bindings = {.vertex_buffers = {vbo},
-              .index_buffer = ibo,
+                                  .mag_filter = SG_FILTER_LINEAR,
+                                  .mipmap_filter = SG_FILTER_LINEAR};
+  bindings = {.index_buffer = ibo,
               .samplers = {sg_make_sampler(&sampler_desc)}};
 
   // Create the Pipeline
   sg_pipeline_desc pip_desc = {.shader = shader,
                                .index_type = SG_INDEXTYPE_UINT16};
-  pip_desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT2;
-  pip_desc.layout.attrs[1].format = SG_VERTEXFORMAT_FLOAT2;
-  pip_desc.layout.attrs[2].format = SG_VERTEXFORMAT_FLOAT4;
-  pip_desc.colors[0].blend = {.enabled = true,
-                              .src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA,
-                              .dst_factor_rgb =
-                                  SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA};
+  pip_desc.layout.attrs[ATTR_unlit2_position].format = SG_VERTEXFORMAT_FLOAT2;
+  pip_desc.layout.attrs[ATTR_unlit2_coords].format = SG_VERTEXFORMAT_USHORT2N;
+  pip_desc.layout.attrs[ATTR_unlit2_vertex_color].format =
+      SG_VERTEXFORMAT_UBYTE4N;
+  // Sprite textures and colors are premultiplied; text and primitives output
+  // straight alpha from their shaders.
+  sg_blend_state premultiplied_blend = {
+      .enabled = true,
+      .src_factor_rgb = SG_BLENDFACTOR_ONE,
+      .dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA};
+  sg_blend_state straight_blend = {
+      .enabled = true,
+      .src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA,
+      .dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA};
+  pip_desc.colors[0].blend = premultiplied_blend;
   pip = sg_make_pipeline(&pip_desc);
 
+  // Instanced sprite pipeline, reusing the first quad of the index buffer
+  const vec2 corners[4] = {
+      {-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}};
+  sg_buffer_desc quad_desc = {.data = SG_RANGE(corners)};
+  quad_vbo = sg_make_buffer(&quad_desc);
+
+  instance_stream.init(MAX_INSTANCES * sizeof(GpuInstance2) * MAX_BATCHES,
+                       "sprite instances");
+
+  instanced_bindings = {.vertex_buffers = {quad_vbo},
+                        .index_buffer = ibo,
+                        .samplers = {bindings.samplers[0]}};
+
+  sg_shader instanced_shader =
+      sg_make_shader(sprite2_shader_desc(sg_query_backend()));
+  sg_pipeline_desc instanced_desc = {.shader = instanced_shader,
+                                     .index_type = SG_INDEXTYPE_UINT16};
+  instanced_desc.layout.buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE;
+  instanced_desc.layout.attrs[ATTR_sprite2_corner] = {
+      .buffer_index = 0, .format = SG_VERTEXFORMAT_FLOAT2};
+  instanced_desc.layout.attrs[ATTR_sprite2_inst_basis] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4};
+  instanced_desc.layout.attrs[ATTR_sprite2_inst_origin] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4};
+  instanced_desc.layout.attrs[ATTR_sprite2_inst_uv] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_USHORT4N};
+  instanced_desc.layout.attrs[ATTR_sprite2_inst_color] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_UBYTE4N};
+  instanced_desc.colors[0].blend = premultiplied_blend;
+  instanced_pip = sg_make_pipeline(&instanced_desc);
+
+  // Primitive pipeline, also expanded from the shared unit quad
+  primitive_stream.init(MAX_INSTANCES * sizeof(GpuPrimitive2), "primitives");
+  primitive_bindings = {.vertex_buffers = {quad_vbo}, .index_buffer = ibo};
+
+  sg_shader primitive_shader =
+      sg_make_shader(primitive2_shader_desc(sg_query_backend()));
+  sg_pipeline_desc primitive_desc = {.shader = primitive_shader,
+                                     .index_type = SG_INDEXTYPE_UINT16};
+  primitive_desc.layout.buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE;
+  primitive_desc.layout.attrs[ATTR_primitive2_corner] = {
+      .buffer_index = 0, .format = SG_VERTEXFORMAT_FLOAT2};
+  primitive_desc.layout.attrs[ATTR_primitive2_inst_points] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4};
+  primitive_desc.layout.attrs[ATTR_primitive2_inst_params] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4};
+  primitive_desc.layout.attrs[ATTR_primitive2_inst_color] = {
+      .buffer_index = 1, .format = SG_VERTEXFORMAT_UBYTE4N};
+  primitive_desc.colors[0].blend = straight_blend;
+  primitive_pip = sg_make_pipeline(&primitive_desc);
+
+  // Text shares the sprite instance layout, only the fragment stage differs
+  text_bindings = instanced_bindings;
+  sg_shader text_shader = sg_make_shader(text2_shader_desc(sg_query_backend()));
+  sg_pipeline_desc text_desc = instanced_desc;
+  text_desc.shader = text_shader;
+  text_desc.colors[0].blend = straight_blend;
+  text_pip = sg_make_pipeline(&text_desc);
+
   camera.zoom = 1.0;
   set_camera_position({0.0, 0.0, -1.0});
 
+  atlas.init(2048);
+  visual_grid.init(256.0f);
+
   // Create white texture
   uint32_t white_pixel = 0xFFFFFFFF;
   sg_image_desc img_desc = {
@@ -101,106 +399,457 @@ void RenderingServer::init() {
   sg_view_desc view_desc = {.texture = {.image = white_texture.image}};
   white_texture.view = sg_make_view(&view_desc);
 
-  // Initialize sokol-gl
-  sgl_desc_t sgl_desc = {};
-  sgl_setup(&sgl_desc);
-
-  // Initialize sokol-fontstash
-  sfons_desc_t sfons_desc = {};
-  sfons_desc.width = 512;
-  sfons_desc.height = 512;
-  fons_context = sfons_create(&sfons_desc);
-  fonsSetAlign(fons_context, FONS_ALIGN_LEFT | FONS_ALIGN_TOP);
-
-  const char *font_path =
-      "/usr/share/fonts/liberation-sans-fonts/LiberationSans-Regular.ttf";
-  FILE *f = fopen(font_path, "rb");
-  if (f) {
-    fseek(f, 0, SEEK_END);
-    int size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    unsigned char *data = (unsigned char *)malloc(size);
-    fread(data, 1, size, f);
-    fclose(f);
-    font_normal = fonsAddFontMem(fons_context, "sans", data, size, 1);
-  } else {
-    font_normal = FONS_INVALID;
-    spdlog::error("Could not load font: {}", font_path);
+  // Placeholders live in the atlas so they batch with the real sprites. They
+  // are pinned, so the page they sit on can still be repacked.
+  const uint32_t clear_pixel = 0x00000000;
+  const uint32_t magenta_pixel = 0xFFFF00FF;
+  loading_texture = atlas.add_pinned((const uint8_t *)&clear_pixel, 1, 1);
+  missing_texture = atlas.add_pinned((const uint8_t *)&magenta_pixel, 1, 1);
+
+  // Id 0 stands for no texture
+  texture_entries.push_back({});
+
+  int workers = (int)std::thread::hardware_concurrency() - 1;
+  decoder.init(std::clamp(workers, 1, 4), vfs);
+
+  // Packed builds ship the font; the system one is a fallback for development
+  auto font = vfs.open("assets/fonts/default.ttf");
+  if (!font.is_valid())
+    font = vfs.open(
+        "/usr/share/fonts/liberation-sans-fonts/LiberationSans-Regular.ttf");
+  text.init(std::move(font), 1024, "font_sdf.cache");
+  text_bindings.views[VIEW_tex] = text.get_texture().view;
+
+  set_draw_list_count(1);
+  frames.start(prepare_frame);
+}
+
+auto RenderingServer::intern_texture(const std::string &path) -> TextureId {
+  auto [it, inserted] =
+      texture_ids.try_emplace(path, (TextureId)texture_entries.size());
+  if (inserted)
+    texture_entries.push_back(
+        {.path = path, .state = TextureState::Unloaded, .refs = 0});
+  return it->second;
+}
+
+void RenderingServer::acquire_texture(TextureId id) {
+  if (id == 0)
+    return;
+
+  auto &entry = texture_entries[id];
+  if (entry.refs++ > 0 || entry.state == TextureState::Loading) {
+    texture_stats.hits++;
+    return;
   }
+
+  texture_stats.misses++;
+  entry.state = TextureState::Loading;
+  decoder.push(entry.path, id);
+}
+
+void RenderingServer::release_texture(TextureId id) {
+  if (id == 0)
+    return;
+
+  auto &entry = texture_entries[id];
+  if (entry.refs == 0) {
+    spdlog::warn("Releasing texture {} more times than it was acquired.",
+                 entry.path);
+    return;
+  }
+  if (--entry.refs > 0)
+    return;
+
+  // A texture still decoding is dropped when it arrives
+  if (entry.state == TextureState::Ready) {
+    atlas.release(entry.texture);
+    texture_stats.live_textures--;
+    texture_stats.texture_bytes -= entry.bytes;
+  }
+  if (entry.state != TextureState::Loading)
+    entry.state = TextureState::Unloaded;
+  entry.texture = {};
+  entry.bytes = 0;
+}
+
+auto RenderingServer::resolve_texture(TextureId id) const
+    -> const GpuTexture & {
+  auto &entry = texture_entries[id];
+  switch (entry.state) {
+  case TextureState::Ready:
+    return entry.texture;
+  case TextureState::Failed:
+    return missing_texture;
+  default:
+    return loading_texture;
+  }
+}
+
+void RenderingServer::upload_decoded_images() {
+  // Images held back by the budget last frame go before any new ones
+  if (decoded_images.empty())
+    decoder.pop_finished(decoded_images, UPLOAD_BUDGET_BYTES);
+
+  size_t done = 0;
+  for (; done < decoded_images.size(); done++) {
+    auto &image = decoded_images[done];
+    auto &entry = texture_entries[image.id];
+
+    // The budget covers whole pages, as that is what gets uploaded. Once it
+    // is spent, only images that fit in a page being uploaded anyway go on.
+    bool over_budget = atlas.get_upload_bytes() >= UPLOAD_BUDGET_BYTES;
+    GpuTexture texture = {};
+    if (entry.refs == 0) {
+      entry.state = TextureState::Unloaded;
+    } else if (image.cooked && image.cooked->is_mipmapped()) {
+      // A mip chain cannot live in an atlas region, so it gets its own image
+      if (over_budget)
+        break;
+
+      auto &cooked = *image.cooked;
+      sg_image_desc desc = {.width = cooked.get_width(),
+                            .height = cooked.get_height(),
+                            .num_mipmaps = cooked.get_mip_count(),
+                            .pixel_format = SG_PIXELFORMAT_RGBA8};
+      for (int level = 0; level < cooked.get_mip_count(); level++) {
+        desc.data.mip_levels[level] = {.ptr = cooked.get_mip_data(level),
+                                       .size = cooked.get_mip(level).size};
+      }
+      texture = atlas.add_standalone(desc, image.byte_size());
+    } else if (image.cooked || image.pixels) {
+      // Cooked sprites are a single level, packed like decoded images
+      auto pixels =
+          image.cooked ? image.cooked->get_mip_data(0) : image.pixels;
+      if (!over_budget)
+        texture = atlas.add(pixels, image.width, image.height);
+      else if (!atlas.add_to_dirty_page(pixels, image.width, image.height,
+                                        texture))
+        break;
+    } else {
+      entry.state = TextureState::Failed;
+    }
+
+    if (texture.image.id != SG_INVALID_ID) {
+      entry.state = TextureState::Ready;
+      entry.texture = texture;
+      entry.bytes = image.byte_size();
+      texture_stats.live_textures++;
+      texture_stats.texture_bytes += entry.bytes;
+    }
+    ImageDecoder::free_image(image);
+  }
+  decoded_images.erase(decoded_images.begin(),
+                       decoded_images.begin() + (ptrdiff_t)done);
+  if (done == 0)
+    return;
+
+  // Swap the placeholders for the real textures
+  for (auto &visual : visuals) {
+    if (visual.texture_id == 0)
+      continue;
+
+    auto &resolved = resolve_texture(visual.texture_id);
+    if (visual.texture.view.id != resolved.view.id)
+      sorted_visuals_dirty = true;
+    if (visual.is_static && !same_region(visual.texture, resolved))
+      static_dirty = true;
+    visual.texture = resolved;
+  }
+}
+
+auto RenderingServer::get_texture_stats() const -> TextureStats {
+  auto stats = texture_stats;
+  stats.resident_bytes = atlas.get_resident_bytes();
+  return stats;
 }
 
 void RenderingServer::draw_visuals() {
-  sgl_defaults();
-  sgl_matrix_mode_projection();
-  // Note: we use a bottom-up coordinate system to match the rest of the engine.
-  sgl_ortho(0.0f, camera.size.x, 0.0f, camera.size.y, -1.0f, 1.0f);
+  upload_decoded_images();
+  atlas.upload();
+  text.upload();
+
+  if (auto frame = frames.acquire_prepared()) {
+    submit_frame(*frame);
+    frames.release();
+  }
+
+  vertex_stream.next_frame();
+  instance_stream.next_frame();
+  primitive_stream.next_frame();
 
-  std::map<uint32_t, std::vector<HandleId>> batch_map;
-  for (auto [id, visual] : visuals) {
-    batch_map[visual.texture.view.id].push_back(id);
+  capture_frame();
+}
+
+void RenderingServer::capture_frame() {
+  build_draw_list();
+  if (static_dirty)
+    rebuild_static_layer();
+
+  auto &frame = frames.begin_capture();
+  frame.mvp = camera.proj * camera.view;
+  frame.zoom = camera.zoom;
+  frame.instancing = use_instancing;
+  frame.static_buffer = static_buffer;
+  frame.static_batches = static_batches;
+
+  frame.visuals.clear();
+  for (auto key : draw_list) {
+    if (auto visual = visuals.get((HandleId)key))
+      frame.visuals.push_back(*visual);
   }
 
-  for (auto [view, ids] : batch_map) {
-    for (auto id : ids) {
-      auto visual = get_visual2(id);
-      queue_visual2(visual);
+  // Stage order keeps the merged frame the same however systems were split
+  // across threads
+  frame.quad_vertices.clear();
+  frame.quad_batches.clear();
+  frame.text_instances.clear();
+  frame.primitives.clear();
+  for (auto &list : draw_lists) {
+    auto first_quad = (uint32_t)(frame.quad_vertices.size() / 4);
+    for (auto batch : list.quad_batches) {
+      batch.first += first_quad;
+      frame.quad_batches.push_back(batch);
+    }
+    frame.quad_vertices.insert(frame.quad_vertices.end(),
+                               list.quad_vertices.begin(),
+                               list.quad_vertices.end());
+    frame.primitives.insert(frame.primitives.end(), list.primitives.begin(),
+                            list.primitives.end());
+    for (auto &command : list.texts) {
+      push_text(command, frame.text_instances);
     }
+    list.clear();
   }
-  flush_visuals2();
 
-  sfons_flush(fons_context);
-  sgl_draw();
+  frames.end_capture();
+  text.end_frame();
 }
 
-void RenderingServer::queue_visual2(Visual2 visual) {
-  if (visual.texture.view.id == 0) {
-    spdlog::warn("Trying to draw with an invalid visual.");
-    return;
+auto RenderingServer::make_instance(const Visual2 &visual) -> GpuInstance2 {
+  return {
+      .basis = {visual.model.x_axis, visual.model.y_axis},
+      .origin = {visual.model.origin, visual.size},
+      .uv = {pack_unorm16(visual.texture.uv.x),
+             pack_unorm16(visual.texture.uv.y),
+             pack_unorm16(visual.texture.uv.z),
+             pack_unorm16(visual.texture.uv.w)},
+      .color = WHITE.to_premultiplied_rgba8(),
+  };
+}
+
+// Runs on the frame thread, so it must only touch `frame`.
+void RenderingServer::prepare_frame(RenderFrame &frame) {
+  frame.sprite_instances.clear();
+  frame.sprite_vertices.clear();
+  frame.sprite_batches.clear();
+
+  for (auto &visual : frame.visuals) {
+    if (visual.texture.view.id == 0) {
+      spdlog::warn("Trying to draw with an invalid visual.");
+      continue;
+    }
+
+    auto instance = make_instance(visual);
+    if (frame.instancing) {
+      auto &batches = frame.sprite_batches;
+      if (batches.empty() || batches.back().view.id != visual.texture.view.id ||
+          batches.back().layer != visual.layer)
+        batches.push_back({visual.texture.view,
+                           (uint32_t)frame.sprite_instances.size(), 0,
+                           visual.layer});
+
+      frame.sprite_instances.push_back(instance);
+      batches.back().count++;
+      continue;
+    }
+
+    // Expand on the CPU the same way sprite2_vs does
+    vec2 origin = {instance.origin.x, instance.origin.y};
+    vec2 half_x = vec2(instance.basis.x, instance.basis.y) * instance.origin.z;
+    vec2 half_y = vec2(instance.basis.z, instance.basis.w) * instance.origin.w;
+    half_x *= 0.5f;
+    half_y *= 0.5f;
+    push_quad(frame.sprite_vertices, frame.sprite_batches,
+              origin - half_x - half_y, origin + half_x - half_y,
+              origin + half_x + half_y, origin - half_x + half_y,
+              instance.color, visual.texture.view, instance.uv, visual.layer);
   }
+}
+
+void RenderingServer::submit_frame(const RenderFrame &frame) {
+  draw_sprites(frame);
+  draw_quads(frame.quad_vertices, frame.quad_batches, frame.mvp);
+
+  if (!frame.text_instances.empty()) {
+    text2_params_t params;
+    std::memcpy(&params.mvp, glm::value_ptr(frame.mvp), sizeof(params.mvp));
+    DrawBatch batch = {text.get_texture().view, 0,
+                       (uint32_t)frame.text_instances.size()};
+    draw_instances(text_pip, text_bindings, frame.text_instances, {batch},
+                   SG_RANGE(params), UB_text2_params);
+  }
+
+  if (!frame.primitives.empty()) {
+    auto allocation = primitive_stream.append(
+        frame.primitives.data(),
+        frame.primitives.size() * sizeof(GpuPrimitive2));
+
+    sg_apply_pipeline(primitive_pip);
+
+    primitive_bindings.vertex_buffers[1] = allocation.buffer;
+    primitive_bindings.vertex_buffer_offsets[1] = allocation.offset;
+    sg_apply_bindings(&primitive_bindings);
 
-  float w = visual.size.x / 2.0f;
-  float h = visual.size.y / 2.0f;
-  glm::vec3 v0 = visual.model * glm::vec3(-w, -h, 1);
-  glm::vec3 v1 = visual.model * glm::vec3(w, -h, 1);
-  glm::vec3 v2 = visual.model * glm::vec3(w, h, 1);
-  glm::vec3 v3 = visual.model * glm::vec3(-w, h, 1);
+    primitive2_params_t params = {};
+    std::memcpy(&params.mvp, glm::value_ptr(frame.mvp), sizeof(params.mvp));
+    params.misc[0] = 1.0f / frame.zoom;
+    auto uniforms = SG_RANGE(params);
+    sg_apply_uniforms(UB_primitive2_params, &uniforms);
 
-  push_quad(v0, v1, v2, v3, WHITE, &visual.texture);
+    sg_draw(0, 6, (int)frame.primitives.size());
+  }
 }
 
-void RenderingServer::flush_visuals2() {
-  if (vertex_buffer.empty())
-    return;
+void RenderingServer::draw_sprites(const RenderFrame &frame) {
+  sprite2_params_t instanced_params;
+  std::memcpy(&instanced_params.mvp, glm::value_ptr(frame.mvp),
+              sizeof(instanced_params.mvp));
+  auto instanced_uniforms = SG_RANGE(instanced_params);
+  vs_params_t quad_params;
+  std::memcpy(&quad_params.mvp, glm::value_ptr(frame.mvp),
+              sizeof(quad_params.mvp));
+  auto quad_uniforms = SG_RANGE(quad_params);
+
+  sg_pipeline current = {};
+  auto use = [&current](sg_pipeline pipeline, const sg_range &uniforms,
+                        int slot) {
+    if (current.id == pipeline.id)
+      return;
+    sg_apply_pipeline(pipeline);
+    sg_apply_uniforms(slot, &uniforms);
+    current = pipeline;
+  };
 
-  // Upload local RAM buffer to GPU RAM
-  int offset = sg_append_buffer(
-      vbo, {.ptr = vertex_buffer.data(),
-            .size = vertex_buffer.size() * sizeof(GpuVertex2)});
-  if (sg_query_buffer_overflow(vbo)) {
-    return;
+  // Static batches go under the dynamic ones on the same layer
+  size_t next_static = 0;
+  auto draw_static_until = [&](int layer) {
+    for (; next_static < frame.static_batches.size() &&
+           frame.static_batches[next_static].layer <= layer;
+         next_static++) {
+      auto &batch = frame.static_batches[next_static];
+      use(instanced_pip, instanced_uniforms, UB_sprite2_params);
+      instanced_bindings.vertex_buffers[1] = frame.static_buffer;
+      instanced_bindings.vertex_buffer_offsets[1] =
+          batch.first * sizeof(GpuInstance2);
+      instanced_bindings.views[VIEW_tex] = batch.view;
+      sg_apply_bindings(&instanced_bindings);
+      sg_draw(0, 6, (int)batch.count);
+    }
+  };
+
+  StreamBuffer::Allocation allocation = {};
+  if (frame.instancing && !frame.sprite_instances.empty())
+    allocation = instance_stream.append(frame.sprite_instances.data(),
+                                        frame.sprite_instances.size() *
+                                            sizeof(GpuInstance2));
+  else if (!frame.instancing && !frame.sprite_vertices.empty())
+    allocation = vertex_stream.append(frame.sprite_vertices.data(),
+                                      frame.sprite_vertices.size() *
+                                          sizeof(GpuVertex2));
+
+  for (auto &batch : frame.sprite_batches) {
+    draw_static_until(batch.layer);
+
+    if (frame.instancing) {
+      use(instanced_pip, instanced_uniforms, UB_sprite2_params);
+      instanced_bindings.vertex_buffers[1] = allocation.buffer;
+      instanced_bindings.vertex_buffer_offsets[1] =
+          allocation.offset + batch.first * sizeof(GpuInstance2);
+      instanced_bindings.views[VIEW_tex] = batch.view;
+      sg_apply_bindings(&instanced_bindings);
+      sg_draw(0, 6, (int)batch.count);
+    } else {
+      use(pip, quad_uniforms, 0);
+      bindings.vertex_buffers[0] = allocation.buffer;
+      bindings.vertex_buffer_offsets[0] =
+          allocation.offset + batch.first * 4 * sizeof(GpuVertex2);
+      bindings.views[0] = batch.view;
+      sg_apply_bindings(&bindings);
+      sg_draw(0, (int)batch.count * 6, 1);
+    }
   }
+  draw_static_until(UINT8_MAX);
+}
 
-  if (sg_query_buffer_overflow(vbo)) {
-    spdlog::error("sokol buffer overflow! increase vbo size.");
-    vertex_buffer.clear();
+void RenderingServer::draw_instances(sg_pipeline pipeline,
+                                     sg_bindings &instance_bindings,
+                                     const std::vector<GpuInstance2> &instances,
+                                     const std::vector<DrawBatch> &batches,
+                                     const sg_range &uniforms,
+                                     int uniform_slot) {
+  if (instances.empty())
     return;
+
+  // One upload for the whole array, batches draw from offsets into it
+  auto allocation = instance_stream.append(
+      instances.data(), instances.size() * sizeof(GpuInstance2));
+
+  sg_apply_pipeline(pipeline);
+  sg_apply_uniforms(uniform_slot, &uniforms);
+
+  instance_bindings.vertex_buffers[1] = allocation.buffer;
+  for (auto &batch : batches) {
+    instance_bindings.vertex_buffer_offsets[1] =
+        allocation.offset + batch.first * sizeof(GpuInstance2);
+    instance_bindings.views[VIEW_tex] = batch.view;
+    sg_apply_bindings(&instance_bindings);
+    sg_draw(0, 6, (int)batch.count);
   }
+}
 
-  sg_apply_pipeline(pip);
+void RenderingServer::draw_quads(const std::vector<GpuVertex2> &vertices,
+                                 const std::vector<DrawBatch> &batches,
+                                 const mat4 &mvp) {
+  if (vertices.empty())
+    return;
 
-  bindings.vertex_buffer_offsets[0] = offset;
-  bindings.views[0] = current_view;
-  sg_apply_bindings(&bindings);
+  auto allocation = vertex_stream.append(
+      vertices.data(), vertices.size() * sizeof(GpuVertex2));
+
+  sg_apply_pipeline(pip);
 
-  auto mvp = camera.proj * camera.view;
   vs_params_t params;
   std::memcpy(&params.mvp, glm::value_ptr(mvp), sizeof(params.mvp));
   auto uniforms = SG_RANGE(params);
   sg_apply_uniforms(0, &uniforms);
 
-  // spdlog::info("vertex buffer size: {}", vertex_buffer.size());
-  sg_draw(0, (int)(vertex_buffer.size() / 4) * 6, 1);
-  vertex_buffer.clear();
+  bindings.vertex_buffers[0] = allocation.buffer;
+  for (auto &batch : batches) {
+    bindings.vertex_buffer_offsets[0] =
+        allocation.offset + batch.first * 4 * sizeof(GpuVertex2);
+    bindings.views[0] = batch.view;
+    sg_apply_bindings(&bindings);
+    sg_draw(0, (int)batch.count * 6, 1);
+  }
+}
+
+void RenderingServer::set_instancing(bool enabled) {
+  use_instancing = enabled;
+}
+
+auto RenderingServer::get_instancing() const -> bool { return use_instancing; }
+
+void RenderingServer::set_draw_list_count(int count) {
+  draw_lists.resize(std::max(count, 1));
+  for (auto &list : draw_lists) {
+    list.cull_bounds = &camera.bounds;
+    list.white_view = white_texture.view;
+  }
+}
+
+auto RenderingServer::get_draw_list(int stage) -> DrawList & {
+  return draw_lists[stage];
 }
 
 void RenderingServer::set_camera_resolution(vec2 size) {
@@ -208,102 +857,110 @@ void RenderingServer::set_camera_resolution(vec2 size) {
   camera.update_mats();
 }
 
-void RenderingServer::draw_line(vec2 p1, vec2 p2, Srgba color,
-                                float thickness) {
-  vec2 dir = p2 - p1;
-  float length = glm::length(dir);
-  if (length < 0.0001f)
+void RenderingServer::push_text(const TextCommand &command,
+                                std::vector<GpuInstance2> &instances) {
+  // Runs are laid out once at the atlas reference size, so zoom only scales
+  auto run = text.get_run(command.text);
+  if (!run || run->glyphs.empty())
     return;
-  vec2 normal = vec2(-dir.y, dir.x) / length;
-  vec2 offset = normal * (thickness * 0.5f);
 
-  vec2 v0 = p1 - offset;
-  vec2 v1 = p2 - offset;
-  vec2 v2 = p2 + offset;
-  vec2 v3 = p1 + offset;
+  float scale = text.get_scale(command.size);
+  vec2 position = command.position;
+  if (!camera.bounds.overlaps(position + run->min * scale,
+                              position + run->max * scale))
+    return;
 
-  push_quad(v0, v1, v2, v3, color, nullptr);
+  uint32_t rgba = command.color.to_rgba8();
+  for (auto &glyph : run->glyphs) {
+    vec2 center = position + glyph.center * scale;
+    vec2 extent = glyph.size * scale;
+    instances.push_back({
+        .basis = {1.0f, 0.0f, 0.0f, 1.0f},
+        .origin = {center.x, center.y, extent.x, extent.y},
+        .uv = {glyph.uv[0], glyph.uv[1], glyph.uv[2], glyph.uv[3]},
+        .color = rgba,
+    });
+  }
 }
 
-void RenderingServer::draw_point(vec2 p, Srgba color, float size) {
-  draw_rect(p, 0.0f, vec2(size, size), color, true);
+auto RenderingServer::get_camera_zoom() const -> float { return camera.zoom; }
+
+auto RenderingServer::get_camera_resolution() const -> vec2 {
+  return camera.size;
 }
 
-void RenderingServer::draw_rect(vec2 p, float r, vec2 size, Srgba color,
-                                bool filled) {
-  vec2 half_size = size * 0.5f;
+auto RenderingServer::get_camera_bounds() const -> Bounds2 {
+  return camera.bounds;
+}
 
-  // Corner offsets before rotation
-  vec2 corners[4] = {
-      vec2(-half_size.x, -half_size.y),
-      vec2(half_size.x, -half_size.y),
-      vec2(half_size.x, half_size.y),
-      vec2(-half_size.x, half_size.y),
-  };
+auto RenderingServer::get_camera_position() const -> vec3 {
+  return camera.position;
+}
 
-  // Rotate and translate each corner
-  float c = cos(r);
-  float s = sin(r);
-  for (vec2 &v : corners) {
-    v = p + vec2(c * v.x - s * v.y, s * v.x + c * v.y);
-  }
+void DrawList::push_primitive(PrimitiveKind kind, vec2 p0, vec2 p1,
+                              float radius, float outline, Srgba color) {
+  float extent = radius + outline;
+  vec2 min = glm::min(p0, p1) - extent;
+  vec2 max = glm::max(p0, p1) + extent;
+  if (!cull_bounds->overlaps(min, max))
+    return;
 
-  if (filled) {
-    push_quad(corners[0], corners[1], corners[2], corners[3], color, nullptr);
-  } else {
-    draw_line(corners[0], corners[1], color);
-    draw_line(corners[1], corners[2], color);
-    draw_line(corners[2], corners[3], color);
-    draw_line(corners[3], corners[0], color);
-  }
+  primitives.push_back({.points = {p0, p1},
+                        .params = {radius, outline, (float)kind, 0.0f},
+                        .color = color.to_rgba8()});
 }
 
-void RenderingServer::draw_circle(vec2 center, float radius, Srgba color,
-                                  int segments) {
-  float angle_step = 2.0f * M_PI / segments;
-  for (int i = 0; i < segments; i++) {
-    float angle1 = i * angle_step;
-    float angle2 = (i + 1) * angle_step;
-    vec2 p1 = center + vec2(cos(angle1), sin(angle1)) * radius;
-    vec2 p2 = center + vec2(cos(angle2), sin(angle2)) * radius;
-    draw_line(p1, p2, color);
-  }
+void DrawList::draw_line(vec2 p1, vec2 p2, Srgba color, float thickness) {
+  push_primitive(PrimitiveKind::Segment, p1, p2, thickness * 0.5f, 0.0f,
+                 color);
+}
+
+void DrawList::draw_point(vec2 p, Srgba color, float size) {
+  draw_rect(p, 0.0f, vec2(size, size), color, true);
 }
-void RenderingServer::draw_text(float x, float y, const char *text, float size,
-                                Srgba color) {
-  if (font_normal == FONS_INVALID)
+
+void DrawList::draw_rect(vec2 p, float r, vec2 size, Srgba color,
+                         bool filled) {
+  vec2 axis = vec2(cos(r), sin(r));
+
+  if (filled) {
+    // A box runs along its axis between the two points
+    vec2 half_length = axis * (size.x * 0.5f);
+    push_primitive(PrimitiveKind::Box, p - half_length, p + half_length,
+                   size.y * 0.5f, 0.0f, color);
     return;
+  }
 
-  fonsClearState(fons_context);
-  fonsSetFont(fons_context, font_normal);
-  fonsSetSize(fons_context, size);
-  // In a bottom-up system, we use BOTTOM alignment so that the text grows
-  // upwards from the provided y-coordinate.
-  fonsSetAlign(fons_context, FONS_ALIGN_LEFT | FONS_ALIGN_BOTTOM);
-  fonsSetColor(fons_context,
-               sfons_rgba((uint8_t)(color.r * 255), (uint8_t)(color.g * 255),
-                          (uint8_t)(color.b * 255), (uint8_t)(color.a * 255)));
+  vec2 half_x = axis * (size.x * 0.5f);
+  vec2 half_y = vec2(-axis.y, axis.x) * (size.y * 0.5f);
+  vec2 corners[4] = {p - half_x - half_y, p + half_x - half_y,
+                     p + half_x + half_y, p - half_x + half_y};
+  draw_polygon(corners, 4, color);
+}
 
-  sgl_matrix_mode_modelview();
-  sgl_push_matrix();
-  sgl_translate(x, y, 0);
-  sgl_scale(1, -1, 1);
-  fonsDrawText(fons_context, 0, 0, text, NULL);
-  sgl_pop_matrix();
+void DrawList::draw_polygon(const vec2 *points, int count, Srgba color,
+                            float thickness) {
+  for (int i = 0; i < count; i++) {
+    draw_line(points[i], points[(i + 1) % count], color, thickness);
+  }
 }
 
-auto RenderingServer::get_camera_zoom() const -> float { return camera.zoom; }
+void DrawList::draw_capsule(vec2 p1, vec2 p2, float radius, Srgba color) {
+  push_primitive(PrimitiveKind::Segment, p1, p2, radius, 0.0f, color);
+}
 
-auto RenderingServer::get_camera_resolution() const -> vec2 {
-  return camera.size;
+void DrawList::draw_circle(vec2 center, float radius, Srgba color,
+                           float thickness) {
+  push_primitive(PrimitiveKind::Ring, center, center, radius,
+                 thickness * 0.5f, color);
 }
 
-auto RenderingServer::get_camera_position() const -> vec3 {
-  return camera.position;
+void DrawList::draw_disc(vec2 center, float radius, Srgba color) {
+  push_primitive(PrimitiveKind::Disc, center, center, radius, 0.0f, color);
 }
-auto RenderingServer::draw_quad(vec2 p1, vec2 p2, vec2 p3, vec2 p4,
-                                vec2 position, float rotation, Srgba color,
-                                bool filled) -> void {
+
+auto DrawList::draw_quad(vec2 p1, vec2 p2, vec2 p3, vec2 p4, vec2 position,
+                         float rotation, Srgba color, bool filled) -> void {
   float c = cos(rotation);
   float s = sin(rotation);
   p1 = position + vec2(c * p1.x - s * p1.y, s * p1.x + c * p1.y);
@@ -312,11 +969,24 @@ auto RenderingServer::draw_quad(vec2 p1, vec2 p2, vec2 p3, vec2 p4,
   p4 = position + vec2(c * p4.x - s * p4.y, s * p4.x + c * p4.y);
 
   if (filled) {
-    push_quad(p1, p2, p3, p4, color, &white_texture);
+    uint16_t uv[4] = {0, 0, 65535, 65535};
+    RenderingServer::push_quad(quad_vertices, quad_batches, p1, p2, p3, p4,
+                               color.to_premultiplied_rgba8(), white_view, uv);
   } else {
-    draw_line(p1, p2, color);
-    draw_line(p2, p3, color);
-    draw_line(p3, p4, color);
-    draw_line(p4, p1, color);
+    vec2 points[4] = {p1, p2, p3, p4};
+    draw_polygon(points, 4, color);
   }
 }
+
+void DrawList::draw_text(vec2 position, const std::string &str, float size,
+                         Srgba color) {
+  texts.push_back(
+      {.position = position, .text = str, .size = size, .color = color});
+}
+
+void DrawList::clear() {
+  primitives.clear();
+  quad_vertices.clear();
+  quad_batches.clear();
+  texts.clear();
+}
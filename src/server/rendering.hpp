@@ -1,6 +1,5 @@
 #pragma once
 
-#include "fontstash.h"
 #include "glm/ext/matrix_clip_space.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/ext/vector_float2.hpp"
@@ -9,8 +8,6 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "sokol_gfx.h"
 
-#include "sokol_fontstash.h"
-#include "sokol_gl.h"
 #include "sokol_log.h"
 #include "spdlog/spdlog.h"
 #include "stb/stb_image.h"
@@ -18,14 +15,23 @@
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
-// fontstash.h (sokol version) is missing this declaration in the header section
-extern "C" int fonsAddFontMem(FONScontext *stash, const char *name,
-                              unsigned char *data, int dataSize, int freeData);
-
+#include "../shaders/primitive2.glsl.h"
+#include "../shaders/sprite2.glsl.h"
+#include "../shaders/text2.glsl.h"
 #include "../shaders/unlit2.glsl.h"
+#include "../math/affine2.hpp"
+#include "atlas.hpp"
+#include "frame_pipeline.hpp"
+#include "image_decoder.hpp"
+#include "slot_map.hpp"
+#include "spatial_grid.hpp"
+#include "stream_buffer.hpp"
+#include "text.hpp"
+#include "vfs.hpp"
 
 using namespace glm;
 
@@ -41,18 +47,67 @@ struct Srgba {
             .b = (hex & 0xFF) / 255.0f,
             .a = 1.0f};
   }
+
+  // Packed as bytes r, g, b, a in memory, for SG_VERTEXFORMAT_UBYTE4N.
+  auto to_rgba8() const -> uint32_t {
+    auto byte = [](float v) {
+      return (uint32_t)(glm::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return byte(r) | (byte(g) << 8) | (byte(b) << 16) | (byte(a) << 24);
+  }
+
+  // For the sprite pipelines, which blend premultiplied alpha.
+  auto to_premultiplied_rgba8() const -> uint32_t {
+    return Srgba{r * a, g * a, b * a, a}.to_rgba8();
+  }
 };
 static const Srgba WHITE = {1.0, 1.0, 1.0, 1.0};
 
+static inline auto pack_unorm16(float v) -> uint16_t {
+  return (uint16_t)(glm::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+// 16 bytes: float2 position, unorm16x2 uv, unorm8x4 color.
 struct GpuVertex2 {
   vec2 position;
-  vec2 uv;
-  Srgba color;
+  uint16_t uv[2];
+  uint32_t color;
+};
+static_assert(sizeof(GpuVertex2) == 16);
+
+// One sprite for the instanced pipeline; the vertex shader expands it over a
+// shared unit quad.
+struct GpuInstance2 {
+  vec4 basis;  // x and y axes of the 2x2 linear part
+  vec4 origin; // translation in xy, size in zw
+  uint16_t uv[4];
+  uint32_t color;
 };
+static_assert(sizeof(GpuInstance2) == 44);
 
-struct GpuTexture {
-  sg_view view;
-  sg_image image;
+enum class PrimitiveKind : uint8_t {
+  Segment,
+  Box,
+  Disc,
+  Ring,
+};
+
+// One debug shape for the primitive pipeline, drawn as a signed distance
+// field over a quad that bounds it.
+struct GpuPrimitive2 {
+  vec4 points; // p0 in xy, p1 in zw
+  vec4 params; // radius or half thickness, outline half width, kind
+  uint32_t color;
+};
+
+struct Bounds2 {
+  vec2 min;
+  vec2 max;
+
+  auto overlaps(vec2 other_min, vec2 other_max) const -> bool {
+    return other_min.x <= max.x && other_max.x >= min.x &&
+           other_min.y <= max.y && other_max.y >= min.y;
+  }
 };
 
 struct CameraData {
@@ -62,6 +117,7 @@ struct CameraData {
 
   mat4 view;
   mat4 proj;
+  Bounds2 bounds;
 
   void update_mats() {
     vec2 center = vec2{size.x, size.y} / 2.0f;
@@ -70,54 +126,234 @@ struct CameraData {
     view = glm::scale(view, {zoom, zoom, 1.0f});
     view = glm::translate(view, {position.x, -position.y, position.z});
     proj = glm::ortho(0.0f, (float)size.x, 0.0f, (float)size.y, -1.0f, 1.0f);
+
+    // Inverse of the view above for the corners of the viewport
+    vec2 offset = {position.x, -position.y};
+    vec2 half_extent = center / zoom;
+    bounds = {.min = -half_extent - offset, .max = half_extent - offset};
   }
 };
 
-typedef uint32_t HandleId;
+// Interned texture path, 0 is no texture.
+typedef uint32_t TextureId;
+
+struct TextureStats {
+  uint64_t hits;   // acquires served by a resident or in-flight texture
+  uint64_t misses; // acquires that started a decode
+  uint32_t live_textures;
+  size_t texture_bytes;  // decoded pixels of live textures
+  size_t resident_bytes; // atlas pages and standalone images
+};
 
 struct Visual2 {
-  mat3 model;
+  Affine2 model;
   vec2 size;
+  TextureId texture_id;
   GpuTexture texture;
+  uint8_t layer;
+  // Baked into the static layer instead of being drawn every frame
+  bool is_static;
 };
 
-class RenderingServer {
-private:
-  sg_pipeline pip;
-  sg_bindings bindings;
-  sg_buffer vbo;
-  sg_buffer ibo;
-  CameraData camera;
-  GpuTexture white_texture;
+// A run of instances, or of quads in a vertex array, drawn with one view.
+struct DrawBatch {
+  sg_view view;
+  uint32_t first;
+  uint32_t count;
+  uint8_t layer;
+};
+
+// What one frame draws, captured when the simulation ends so the next one
+// can run while this is prepared and submitted.
+struct RenderFrame {
+  mat4 mvp;
+  float zoom;
+  bool instancing;
+  sg_buffer static_buffer;
+  std::vector<DrawBatch> static_batches;
+  std::vector<Visual2> visuals; // in draw order
+  std::vector<GpuVertex2> quad_vertices;
+  std::vector<DrawBatch> quad_batches;
+  std::vector<GpuInstance2> text_instances;
+  std::vector<GpuPrimitive2> primitives;
+
+  // Built from `visuals` on the frame thread
+  std::vector<GpuInstance2> sprite_instances;
+  std::vector<GpuVertex2> sprite_vertices;
+  std::vector<DrawBatch> sprite_batches;
+};
 
-  std::map<HandleId, Visual2> visuals;
-  std::vector<HandleId> free_ids;
-  uint32_t next_id;
+// A label recorded during the frame, laid out when the frame is captured.
+struct TextCommand {
+  vec2 position;
+  std::string text;
+  float size;
+  Srgba color;
+};
 
-  std::vector<GpuVertex2> vertex_buffer;
-  sg_view current_view;
+// Debug shapes, filled quads and labels recorded by one thread. Systems on
+// flecs worker threads record into the list of their stage, and the lists are
+// merged in stage order when the frame is captured, so what gets drawn does
+// not depend on how the work was scheduled.
+class DrawList {
+private:
+  friend class RenderingServer;
 
-  FONScontext *fons_context;
-  int font_normal;
+  const Bounds2 *cull_bounds = nullptr;
+  sg_view white_view = {};
+  std::vector<GpuPrimitive2> primitives;
+  std::vector<GpuVertex2> quad_vertices;
+  std::vector<DrawBatch> quad_batches;
+  // Glyph lookups touch the text cache, which belongs to the main thread
+  std::vector<TextCommand> texts;
 
-  const int MAX_VERTICES = 10000;
-  const int MAX_BATCHES = 20;
+  void push_primitive(PrimitiveKind kind, vec2 p0, vec2 p1, float radius,
+                      float outline, Srgba color);
+  void clear();
 
-  HandleId get_next_id();
+public:
+  void draw_line(vec2 p1, vec2 p2, Srgba color, float thickness = 1.0f);
+  void draw_point(vec2 p, Srgba color, float size = 1.0f);
+  void draw_rect(vec2 p, float r, vec2 size, Srgba color, bool filled = false);
+  auto draw_quad(vec2 p1, vec2 p2, vec2 p3, vec2 p4, vec2 position,
+                 float rotation, Srgba color, bool filled = false) -> void;
+  void draw_polygon(const vec2 *points, int count, Srgba color,
+                    float thickness = 1.0f);
+  void draw_capsule(vec2 p1, vec2 p2, float radius, Srgba color);
+  void draw_circle(vec2 center, float radius, Srgba color,
+                   float thickness = 1.0f);
+  void draw_disc(vec2 center, float radius, Srgba color);
+  // Draws text in world units with its baseline origin at `position`.
+  void draw_text(vec2 position, const std::string &text, float size,
+                 Srgba color);
+};
 
-  void push_quad(vec2 v0, vec2 v1, vec2 v2, vec2 v3, Srgba color,
-                 GpuTexture *texture) {
-    GpuTexture *t = texture ? texture : &white_texture;
-    if (t->view.id != current_view.id ||
-        vertex_buffer.size() + 4 >= MAX_VERTICES) {
-      flush_visuals2();
-      current_view = t->view;
-    }
+class RenderingServer {
+private:
+  friend class DrawList;
 
-    vertex_buffer.push_back({v0, {0, 0}, color});
-    vertex_buffer.push_back({v1, {1, 0}, color});
-    vertex_buffer.push_back({v2, {1, 1}, color});
-    vertex_buffer.push_back({v3, {0, 1}, color});
+  sg_pipeline pip;
+  sg_bindings bindings;
+  StreamBuffer vertex_stream;
+  sg_buffer ibo;
+  CameraData camera;
+  GpuTexture white_texture;
+  TextureAtlas atlas;
+
+  SlotMap<Visual2> visuals;
+
+  // Sprite textures by interned path, refcounted by the visuals using them.
+  // Files are decoded off-thread and added to the atlas while its pending
+  // upload, whole pages included, stays within UPLOAD_BUDGET_BYTES per frame.
+  // Images over the budget wait in decoded_images. Unused textures go back to
+  // the atlas.
+  enum class TextureState : uint8_t { Unloaded, Loading, Ready, Failed };
+  struct TextureEntry {
+    std::string path;
+    TextureState state;
+    uint32_t refs;
+    GpuTexture texture;
+    size_t bytes;
+  };
+  ImageDecoder decoder;
+  std::unordered_map<std::string, TextureId> texture_ids;
+  std::vector<TextureEntry> texture_entries; // indexed by TextureId
+  std::vector<ImageDecoder::Image> decoded_images;
+  TextureStats texture_stats = {};
+  GpuTexture loading_texture;
+  GpuTexture missing_texture;
+
+  // Dynamic visuals by bounds. Each frame only those overlapping the camera
+  // make it into the draw list.
+  SpatialGrid visual_grid;
+  std::vector<HandleId> visible_visuals;
+  std::vector<uint8_t> visible_marks; // indexed by handle_index
+
+  // Sort keys are (layer, pipeline, view) in the high 32 bits and the visual
+  // handle in the low 32 bits. All dynamic visuals are kept sorted, resorted
+  // only when marked dirty, and the draw list is the visible part of them.
+  std::vector<uint64_t> sorted_visuals;
+  std::vector<uint64_t> draw_list;
+  std::vector<uint64_t> draw_list_scratch;
+  bool sorted_visuals_dirty = true;
+
+  // Static visuals live in an immutable instance buffer, rebuilt only when
+  // one of them is added, removed or changed. Batches are per layer and view.
+  std::vector<DrawBatch> static_batches;
+  sg_buffer static_buffer = {};
+  bool static_dirty = false;
+
+  // One per flecs stage, the first belongs to the main thread
+  std::vector<DrawList> draw_lists;
+
+  // Instanced sprite path. Disabled falls back to CPU-expanded quads.
+  bool use_instancing = true;
+  sg_pipeline instanced_pip;
+  sg_bindings instanced_bindings;
+  sg_buffer quad_vbo;
+  StreamBuffer instance_stream;
+
+  // Debug shapes, recorded during the frame and drawn in one call
+  sg_pipeline primitive_pip;
+  sg_bindings primitive_bindings;
+  StreamBuffer primitive_stream;
+
+  // Labels, drawn as sprite instances over the SDF glyph atlas
+  TextCache text;
+  sg_pipeline text_pip;
+  sg_bindings text_bindings;
+
+  // Frames are captured at the end of draw_visuals and turned into batches on
+  // a worker thread, then submitted during the next draw_visuals. The sokol
+  // context stays on the app thread.
+  FramePipeline<RenderFrame> frames;
+
+  static constexpr int MAX_VERTICES = 10000;
+  // Initial stream buffer size in batches; it grows when a frame needs more.
+  const int MAX_BATCHES = 40;
+  static constexpr int MAX_INSTANCES = MAX_VERTICES / 4;
+  static constexpr uint8_t SPRITE_PIPELINE = 0;
+  static constexpr size_t UPLOAD_BUDGET_BYTES = 4 * 1024 * 1024;
+
+  static auto make_sort_key(const Visual2 &visual, HandleId id) -> uint64_t;
+  void rebuild_sorted_visuals();
+  void build_draw_list();
+  static auto visual_bounds(const Visual2 &visual) -> Bounds2;
+  void update_grid(const HandleId &id, const Visual2 &visual);
+  void rebuild_static_layer();
+  void upload_decoded_images();
+  void acquire_texture(TextureId id);
+  void release_texture(TextureId id);
+  auto resolve_texture(TextureId id) const -> const GpuTexture &;
+  void capture_frame();
+  void push_text(const TextCommand &command,
+                 std::vector<GpuInstance2> &instances);
+  static void prepare_frame(RenderFrame &frame);
+  void submit_frame(const RenderFrame &frame);
+  void draw_instances(sg_pipeline pipeline, sg_bindings &instance_bindings,
+                      const std::vector<GpuInstance2> &instances,
+                      const std::vector<DrawBatch> &batches,
+                      const sg_range &uniforms, int uniform_slot);
+  void draw_quads(const std::vector<GpuVertex2> &vertices,
+                  const std::vector<DrawBatch> &batches, const mat4 &mvp);
+  void draw_sprites(const RenderFrame &frame);
+  static auto make_instance(const Visual2 &visual) -> GpuInstance2;
+
+  // Appends a quad to `vertices`, starting a batch when the view or layer
+  // changes or the index buffer would run out.
+  static void push_quad(std::vector<GpuVertex2> &vertices,
+                        std::vector<DrawBatch> &batches, vec2 v0, vec2 v1,
+                        vec2 v2, vec2 v3, uint32_t rgba, sg_view view,
+                        const uint16_t uv[4], uint8_t layer = 0) {
+    if (batches.empty() || batches.back().view.id != view.id ||
+        batches.back().layer != layer || batches.back().count == MAX_INSTANCES)
+      batches.push_back({view, (uint32_t)(vertices.size() / 4), 0, layer});
+
+    vertices.push_back({v0, {uv[0], uv[1]}, rgba});
+    vertices.push_back({v1, {uv[2], uv[1]}, rgba});
+    vertices.push_back({v2, {uv[2], uv[3]}, rgba});
+    vertices.push_back({v3, {uv[0], uv[3]}, rgba});
+    batches.back().count++;
   }
 
 public:
@@ -130,6 +366,9 @@ public:
   void set_camera_resolution(vec2 size);
   auto get_camera_resolution() const -> vec2;
 
+  // Visible world rectangle
+  auto get_camera_bounds() const -> Bounds2;
+
   auto screen_to_world(glm::vec2 screen_pos) -> glm::vec2 {
     auto world = screen_pos - camera.size / 2.0f;
     return glm::vec2{world.x, world.y};
@@ -141,24 +380,49 @@ public:
     return (world_pos + offset) * camera.zoom + camera.size / 2.0f;
   }
 
+  // Packs RGBA8 pixels into the sprite atlas. Pixels are copied.
+  auto add_texture(const uint8_t *pixels, int width, int height)
+      -> GpuTexture {
+    return atlas.add(pixels, width, height);
+  }
+
+  // Maps a path to a stable id without loading it. The image is decoded in
+  // the background once a visual uses the id, and released when the last one
+  // stops. Meanwhile visuals draw a transparent placeholder; files that fail
+  // to decode draw magenta.
+  auto intern_texture(const std::string &path) -> TextureId;
+
+  auto get_texture_stats() const -> TextureStats;
+
   HandleId new_visual2();
 
-  Visual2 &get_visual2(const HandleId &id);
+  // Returns nullptr if the handle is stale or was never issued.
+  Visual2 *get_visual2(const HandleId &id);
 
   void delete_visual2(const HandleId &id);
 
-  void init();
+  // Texture and layer feed the sort key, and static visuals are rebaked on
+  // any change, so visuals must be modified through these.
+  void set_visual2_texture(const HandleId &id, TextureId texture);
+  void set_visual2_texture(const HandleId &id, const GpuTexture &texture);
+  void set_visual2_layer(const HandleId &id, uint8_t layer);
+  void set_visual2_model(const HandleId &id, const Affine2 &model);
+  void set_visual2_size(const HandleId &id, vec2 size);
+  void set_visual2_static(const HandleId &id, bool is_static);
 
+  void init(const Vfs &vfs);
+
+  // Uploads pending textures, submits the previous frame and captures this
+  // one. Must be called inside a pass.
   void draw_visuals();
 
-  void queue_visual2(Visual2 visual);
+  void set_instancing(bool enabled);
+  auto get_instancing() const -> bool;
 
-  void flush_visuals2();
-  void draw_line(vec2 p1, vec2 p2, Srgba color, float thickness = 1.0f);
-  void draw_point(vec2 p, Srgba color, float size = 1.0f);
-  void draw_rect(vec2 p, float r, vec2 size, Srgba color, bool filled = false);
-  auto draw_quad(vec2 p1, vec2 p2, vec2 p3, vec2 p4, vec2 position,
-                 float rotation, Srgba color, bool filled = false) -> void;
-  void draw_circle(vec2 center, float radius, Srgba color, int segments = 32);
-  void draw_text(float x, float y, const char *text, float size, Srgba color);
+  // Makes one draw list per flecs stage. Call before systems run.
+  void set_draw_list_count(int count);
+
+  // Where the frame's debug shapes, quads and labels are recorded. Systems
+  // that run multi threaded pass their stage id.
+  auto get_draw_list(int stage = 0) -> DrawList &;
 };
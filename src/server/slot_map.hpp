@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A handle packs the slot index in the low bits and the slot generation in
+// the high bits. Generations start at 1, so a zeroed handle is never valid.
+typedef uint32_t HandleId;
+
+static constexpr uint32_t HANDLE_INDEX_BITS = 20;
+
+// Slot index of a handle, for side tables indexed alongside a SlotMap.
+inline auto handle_index(HandleId id) -> uint32_t {
+  return id & ((1u << HANDLE_INDEX_BITS) - 1);
+}
+
+// Dense storage with generational handles. Values live contiguously and are
+// swap-removed on erase; slots map stable handles to their dense position.
+template <typename T> class SlotMap {
+public:
+  static constexpr uint32_t INDEX_BITS = HANDLE_INDEX_BITS;
+  static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+private:
+  static constexpr uint32_t INVALID = UINT32_MAX;
+
+  struct Slot {
+    uint32_t dense = INVALID;
+    uint32_t generation = 1;
+  };
+
+  std::vector<Slot> slots;
+  std::vector<uint32_t> free_slots;
+  std::vector<T> values;
+  std::vector<HandleId> owners;
+
+  auto find_slot(HandleId id) const -> const Slot * {
+    uint32_t index = id & INDEX_MASK;
+    if (index >= slots.size())
+      return nullptr;
+
+    const Slot &slot = slots[index];
+    if (slot.dense == INVALID || slot.generation != (id >> INDEX_BITS))
+      return nullptr;
+
+    return &slot;
+  }
+
+public:
+  auto insert(T value = {}) -> HandleId {
+    uint32_t index;
+    if (!free_slots.empty()) {
+      index = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      index = (uint32_t)slots.size();
+      slots.push_back({});
+    }
+
+    Slot &slot = slots[index];
+    slot.dense = (uint32_t)values.size();
+    HandleId id = (slot.generation << INDEX_BITS) | index;
+    values.push_back(std::move(value));
+    owners.push_back(id);
+    return id;
+  }
+
+  auto erase(HandleId id) -> bool {
+    if (!find_slot(id))
+      return false;
+
+    Slot &slot = slots[id & INDEX_MASK];
+    uint32_t dense = slot.dense;
+    uint32_t last = (uint32_t)values.size() - 1;
+    if (dense != last) {
+      values[dense] = std::move(values[last]);
+      owners[dense] = owners[last];
+      slots[owners[dense] & INDEX_MASK].dense = dense;
+    }
+    values.pop_back();
+    owners.pop_back();
+
+    slot.dense = INVALID;
+    slot.generation = (slot.generation + 1) & GENERATION_MASK;
+    if (slot.generation == 0)
+      slot.generation = 1;
+    free_slots.push_back(id & INDEX_MASK);
+    return true;
+  }
+
+  auto get(HandleId id) -> T * {
+    auto slot = find_slot(id);
+    return slot ? &values[slot->dense] : nullptr;
+  }
+
+  auto get(HandleId id) const -> const T * {
+    auto slot = find_slot(id);
+    return slot ? &values[slot->dense] : nullptr;
+  }
+
+  auto contains(HandleId id) const -> bool { return find_slot(id) != nullptr; }
+
+  auto size() const -> size_t { return values.size(); }
+  auto empty() const -> bool { return values.empty(); }
+
+  // Dense access, valid until the next insert or erase.
+  auto data() -> T * { return values.data(); }
+  auto data() const -> const T * { return values.data(); }
+  auto handle_at(size_t dense) const -> HandleId { return owners[dense]; }
+
+  auto begin() { return values.begin(); }
+  auto end() { return values.end(); }
+  auto begin() const { return values.begin(); }
+  auto end() const { return values.end(); }
+};
@@ -0,0 +1,107 @@
+#include "spatial_grid.hpp"
+#include <cmath>
+
+static auto pack_cell(int32_t x, int32_t y) -> uint64_t {
+  return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+void SpatialGrid::init(float size) { cell_size = size; }
+
+auto SpatialGrid::cell_of(glm::vec2 min, glm::vec2 max) const -> uint64_t {
+  glm::vec2 extent = max - min;
+  if (extent.x > cell_size || extent.y > cell_size)
+    return OVERSIZED;
+
+  glm::vec2 center = (min + max) * 0.5f;
+  return pack_cell((int32_t)std::floor(center.x / cell_size),
+                   (int32_t)std::floor(center.y / cell_size));
+}
+
+auto SpatialGrid::list_of(uint64_t cell) -> std::vector<uint32_t> & {
+  return cell == OVERSIZED ? oversized : cells[cell];
+}
+
+void SpatialGrid::link(uint32_t index, uint64_t cell) {
+  auto &list = list_of(cell);
+  items[index].cell = cell;
+  items[index].position = (uint32_t)list.size();
+  list.push_back(index);
+}
+
+void SpatialGrid::unlink(uint32_t index) {
+  auto &item = items[index];
+  auto &list = list_of(item.cell);
+  uint32_t moved = list.back();
+  list[item.position] = moved;
+  items[moved].position = item.position;
+  list.pop_back();
+
+  // Empty cells are dropped so a query never walks more cells than exist
+  if (list.empty() && item.cell != OVERSIZED)
+    cells.erase(item.cell);
+}
+
+void SpatialGrid::update(HandleId id, glm::vec2 min, glm::vec2 max) {
+  uint32_t index = handle_index(id);
+  if (index >= items.size())
+    items.resize(index + 1);
+
+  auto &item = items[index];
+  uint64_t cell = cell_of(min, max);
+  if (!item.live) {
+    item = {.id = id, .live = true};
+    link(index, cell);
+  } else if (item.cell != cell) {
+    unlink(index);
+    link(index, cell);
+  }
+  items[index].id = id;
+  items[index].min = min;
+  items[index].max = max;
+}
+
+void SpatialGrid::remove(HandleId id) {
+  uint32_t index = handle_index(id);
+  if (index >= items.size() || !items[index].live)
+    return;
+
+  unlink(index);
+  items[index].live = false;
+}
+
+void SpatialGrid::query(glm::vec2 min, glm::vec2 max,
+                        std::vector<HandleId> &out) const {
+  auto test = [&](const std::vector<uint32_t> &list) {
+    for (auto index : list) {
+      auto &item = items[index];
+      if (item.min.x <= max.x && item.max.x >= min.x && item.min.y <= max.y &&
+          item.max.y >= min.y)
+        out.push_back(item.id);
+    }
+  };
+  test(oversized);
+
+  // Items overhang their cell by up to half a cell
+  float margin = cell_size * 0.5f;
+  auto first_x = (int64_t)std::floor((min.x - margin) / cell_size);
+  auto first_y = (int64_t)std::floor((min.y - margin) / cell_size);
+  auto last_x = (int64_t)std::floor((max.x + margin) / cell_size);
+  auto last_y = (int64_t)std::floor((max.y + margin) / cell_size);
+
+  // Zoomed far out it is cheaper to walk the occupied cells
+  int64_t span = (last_x - first_x + 1) * (last_y - first_y + 1);
+  if (span > (int64_t)cells.size()) {
+    for (auto &[cell, list] : cells) {
+      test(list);
+    }
+    return;
+  }
+
+  for (auto y = first_y; y <= last_y; y++) {
+    for (auto x = first_x; x <= last_x; x++) {
+      auto it = cells.find(pack_cell((int32_t)x, (int32_t)y));
+      if (it != cells.end())
+        test(it->second);
+    }
+  }
+}
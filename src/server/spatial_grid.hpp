@@ -0,0 +1,45 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "slot_map.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Loose uniform grid over axis aligned bounds, keyed by handle. Items live in
+// the cell under their center and may overhang it by half a cell, so queries
+// widen by that much and moving an item only touches the grid when it crosses
+// into another cell. Items too big for that are kept aside and always tested.
+class SpatialGrid {
+private:
+  static constexpr uint64_t OVERSIZED = UINT64_MAX;
+
+  struct Item {
+    glm::vec2 min;
+    glm::vec2 max;
+    HandleId id;
+    uint64_t cell;
+    uint32_t position; // index in the cell's list
+    bool live;
+  };
+
+  float cell_size = 256.0f;
+  std::vector<Item> items; // indexed by handle_index
+  std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+  std::vector<uint32_t> oversized;
+
+  auto cell_of(glm::vec2 min, glm::vec2 max) const -> uint64_t;
+  auto list_of(uint64_t cell) -> std::vector<uint32_t> &;
+  void link(uint32_t index, uint64_t cell);
+  void unlink(uint32_t index);
+
+public:
+  void init(float cell_size);
+
+  // Adds or moves the item.
+  void update(HandleId id, glm::vec2 min, glm::vec2 max);
+  void remove(HandleId id);
+
+  // Appends the handles of items overlapping the rectangle.
+  void query(glm::vec2 min, glm::vec2 max, std::vector<HandleId> &out) const;
+};
@@ -0,0 +1,60 @@
+#include "stream_buffer.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <bit>
+
+void StreamBuffer::add_chunk(size_t size) {
+  sg_buffer_desc desc = {.size = size,
+                         .usage = {.stream_update = true},
+                         .label = label};
+  chunks.push_back({.buffer = sg_make_buffer(&desc), .size = size, .used = 0});
+}
+
+void StreamBuffer::init(size_t initial_size, const char *name) {
+  label = name;
+  add_chunk(initial_size);
+}
+
+void StreamBuffer::next_frame() {
+  high_water = std::max(high_water, frame_bytes);
+
+  if (chunks.size() > 1) {
+    size_t old_size = chunks.front().size;
+    size_t new_size = std::bit_ceil(high_water);
+    for (auto &chunk : chunks) {
+      sg_destroy_buffer(chunk.buffer);
+    }
+    chunks.clear();
+    add_chunk(new_size);
+    spdlog::info("stream buffer '{}' grew from {} to {} bytes", label,
+                 old_size, new_size);
+  }
+
+  for (auto &chunk : chunks) {
+    chunk.used = 0;
+  }
+  current = 0;
+  frame_bytes = 0;
+}
+
+auto StreamBuffer::append(const void *data, size_t size) -> Allocation {
+  while (chunks[current].used + size > chunks[current].size) {
+    current++;
+    if (current == chunks.size())
+      add_chunk(std::max(chunks.front().size, size));
+  }
+
+  auto &chunk = chunks[current];
+  int offset = sg_append_buffer(chunk.buffer, {.ptr = data, .size = size});
+  chunk.used += size;
+  frame_bytes += size;
+  return {.buffer = chunk.buffer, .offset = offset};
+}
+
+auto StreamBuffer::get_capacity() const -> size_t {
+  size_t capacity = 0;
+  for (auto &chunk : chunks) {
+    capacity += chunk.size;
+  }
+  return capacity;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "sokol_gfx.h"
+#include <cstddef>
+#include <vector>
+
+// Per-frame streaming storage for vertex data. Each chunk is a sokol stream
+// buffer, which sokol already rotates across its in-flight frames. When a
+// frame runs past the first chunk, data spills into extra chunks so nothing
+// is dropped. The next frame then starts with one chunk sized for the
+// high-water mark.
+class StreamBuffer {
+private:
+  struct Chunk {
+    sg_buffer buffer;
+    size_t size;
+    size_t used;
+  };
+
+  std::vector<Chunk> chunks;
+  size_t current = 0;
+  size_t frame_bytes = 0;
+  size_t high_water = 0;
+  const char *label = "";
+
+  void add_chunk(size_t size);
+
+public:
+  struct Allocation {
+    sg_buffer buffer;
+    int offset;
+  };
+
+  void init(size_t initial_size, const char *label);
+
+  // Call after the last append of a frame. Resets the chunks for the next
+  // frame and grows them if this one spilled.
+  void next_frame();
+
+  auto append(const void *data, size_t size) -> Allocation;
+
+  auto get_capacity() const -> size_t;
+  auto get_high_water() const -> size_t { return high_water; }
+};
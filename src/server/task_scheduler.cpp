@@ -0,0 +1,146 @@
+#include "task_scheduler.hpp"
+#include <algorithm>
+#include <cassert>
+
+// Worker index of the calling thread. The thread that called init is worker 0.
+static thread_local uint32_t current_worker = 0;
+static thread_local bool is_worker_thread = false;
+
+// Box2D hands each worker a solver task that spin-waits on the others, so
+// workers poll for a while before going to sleep
+static constexpr int SPIN_COUNT = 2000;
+
+TaskScheduler::~TaskScheduler() { shutdown(); }
+
+void TaskScheduler::init(int worker_count) {
+  owner = std::this_thread::get_id();
+  worker_count = std::max(worker_count, 1);
+  for (int i = 0; i < worker_count; i++) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (int i = 1; i < worker_count; i++) {
+    threads.emplace_back(&TaskScheduler::work, this, (uint32_t)i);
+  }
+}
+
+void TaskScheduler::shutdown() {
+  {
+    std::lock_guard lock(sleep_mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+}
+
+auto TaskScheduler::submit(Callback callback, int32_t item_count,
+                           int32_t min_range, void *context) -> Task * {
+  assert(is_owning_thread() && "tasks must come from the owner or a worker");
+  Task *task;
+  {
+    std::lock_guard lock(pool_mutex);
+    if (free_tasks.empty()) {
+      tasks.push_back(std::make_unique<Task>());
+      free_tasks.push_back(tasks.back().get());
+    }
+    task = free_tasks.back();
+    free_tasks.pop_back();
+  }
+  task->callback = callback;
+  task->context = context;
+
+  // A few ranges per worker leaves something to steal when they run unevenly
+  auto workers = (int32_t)queues.size();
+  auto count = std::clamp(item_count / std::max(min_range, 1), 1, workers * 4);
+  auto size = (item_count + count - 1) / std::max(count, 1);
+  count = item_count > 0 ? (item_count + size - 1) / size : 0;
+  task->pending.store(count);
+  if (count == 0)
+    return task;
+
+  uint32_t first = next_queue.fetch_add((uint32_t)count);
+  for (int32_t i = 0; i < count; i++) {
+    auto &queue = *queues[(first + i) % workers];
+    std::lock_guard lock(queue.mutex);
+    queue.ranges.push_back(
+        {task, i * size, std::min(item_count, (i + 1) * size)});
+  }
+  queued += count;
+
+  // Taking the lock orders this against a worker about to sleep
+  { std::lock_guard lock(sleep_mutex); }
+  wake.notify_all();
+  return task;
+}
+
+void TaskScheduler::wait(Task *task) {
+  assert(is_owning_thread() && "only the owner or a worker may wait");
+  while (task->pending.load(std::memory_order_acquire) > 0) {
+    Range range;
+    if (pop(current_worker, range))
+      run(range, current_worker);
+    else
+      std::this_thread::yield();
+  }
+
+  std::lock_guard lock(pool_mutex);
+  free_tasks.push_back(task);
+}
+
+auto TaskScheduler::pop(uint32_t worker, Range &range) -> bool {
+  if (queued.load(std::memory_order_relaxed) <= 0)
+    return false;
+
+  // Newest first from our own queue, oldest first from the others
+  auto count = (uint32_t)queues.size();
+  for (uint32_t i = 0; i < count; i++) {
+    auto &queue = *queues[(worker + i) % count];
+    std::lock_guard lock(queue.mutex);
+    if (queue.ranges.empty())
+      continue;
+
+    if (i == 0) {
+      range = queue.ranges.back();
+      queue.ranges.pop_back();
+    } else {
+      range = queue.ranges.front();
+      queue.ranges.pop_front();
+    }
+    queued--;
+    return true;
+  }
+  return false;
+}
+
+auto TaskScheduler::is_owning_thread() const -> bool {
+  return is_worker_thread || std::this_thread::get_id() == owner;
+}
+
+void TaskScheduler::run(const Range &range, uint32_t worker) {
+  auto task = range.task;
+  task->callback(range.start, range.end, worker, task->context);
+  task->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskScheduler::work(uint32_t worker) {
+  current_worker = worker;
+  is_worker_thread = true;
+  while (true) {
+    Range range;
+    if (pop(worker, range)) {
+      run(range, worker);
+      continue;
+    }
+
+    for (int i = 0; i < SPIN_COUNT && queued.load() <= 0; i++) {
+      std::this_thread::yield();
+    }
+
+    std::unique_lock lock(sleep_mutex);
+    wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+    if (stopping)
+      return;
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join scheduler for data parallel work like the Box2D solver. A task is
+// split into ranges spread over one queue per worker; idle workers steal from
+// the others, and a thread waiting on a task runs ranges meanwhile. The thread
+// that calls init is worker 0, and only it and the workers may submit or wait:
+// Box2D keeps scratch space per worker index, so two threads acting as worker
+// 0 would share it.
+class TaskScheduler {
+public:
+  using Callback = void (*)(int32_t start, int32_t end, uint32_t worker,
+                            void *context);
+
+  struct Task {
+    Callback callback;
+    void *context;
+    std::atomic<int32_t> pending; // ranges not finished yet
+  };
+
+private:
+  struct Range {
+    Task *task;
+    int32_t start;
+    int32_t end;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Range> ranges;
+  };
+
+  std::thread::id owner;
+  std::vector<std::thread> threads;
+  std::vector<std::unique_ptr<Queue>> queues; // indexed by worker
+  std::atomic<int32_t> queued = 0;
+  std::atomic<uint32_t> next_queue = 0;
+
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  // Tasks are recycled once waited on, so their addresses stay valid
+  std::mutex pool_mutex;
+  std::vector<std::unique_ptr<Task>> tasks;
+  std::vector<Task *> free_tasks;
+
+  void work(uint32_t worker);
+  auto pop(uint32_t worker, Range &range) -> bool;
+  void run(const Range &range, uint32_t worker);
+  auto is_owning_thread() const -> bool;
+
+public:
+  ~TaskScheduler();
+
+  void init(int worker_count);
+  void shutdown();
+
+  auto get_worker_count() const -> int { return (int)queues.size(); }
+
+  // Splits [0, item_count) into ranges of at least `min_range` items. The
+  // task must be waited on.
+  auto submit(Callback callback, int32_t item_count, int32_t min_range,
+              void *context) -> Task *;
+
+  // Runs queued ranges until `task` is done.
+  void wait(Task *task);
+};
@@ -0,0 +1,291 @@
+#include "text.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static auto pack_uv(float v) -> uint16_t {
+  return (uint16_t)(glm::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+// Decodes one UTF-8 sequence at `i` and advances past it. Malformed bytes
+// decode as U+FFFD.
+static auto decode_utf8(const std::string &text, size_t &i) -> uint32_t {
+  uint8_t lead = text[i++];
+  int extra = 0;
+  uint32_t codepoint = lead;
+  if (lead >= 0xF0) {
+    extra = 3;
+    codepoint = lead & 0x07;
+  } else if (lead >= 0xE0) {
+    extra = 2;
+    codepoint = lead & 0x0F;
+  } else if (lead >= 0xC0) {
+    extra = 1;
+    codepoint = lead & 0x1F;
+  } else if (lead >= 0x80) {
+    return 0xFFFD;
+  }
+
+  for (int n = 0; n < extra; n++) {
+    if (i == text.size() || ((uint8_t)text[i] & 0xC0) != 0x80)
+      return 0xFFFD;
+    codepoint = (codepoint << 6) | ((uint8_t)text[i++] & 0x3F);
+  }
+  return codepoint;
+}
+
+void TextCache::init(VfsFile font_source, int size, const char *cache_path) {
+  if (!font_source.is_valid()) {
+    spdlog::error("Could not load font");
+    return;
+  }
+
+  // stb_truetype only reads through this pointer
+  font_file = std::move(font_source);
+  auto data = (unsigned char *)font_file.data().data();
+  if (!stbtt_InitFont(&font, data, stbtt_GetFontOffsetForIndex(data, 0))) {
+    spdlog::error("Could not parse font");
+    return;
+  }
+
+  // Same sizing as fontstash: `size` is the ascent to descent height
+  scale = stbtt_ScaleForPixelHeight(&font, REFERENCE_SIZE);
+  int ascent, descent_units, line_gap;
+  stbtt_GetFontVMetrics(&font, &ascent, &descent_units, &line_gap);
+  descent = descent_units * scale;
+
+  atlas_size = size;
+  pixels.assign((size_t)size * size, 0);
+  packer = SkylinePacker(size, size);
+  valid = true;
+
+  if (!cache_path || !load_cache(cache_path)) {
+    for (uint32_t codepoint = 32; codepoint < 127; codepoint++) {
+      get_glyph(codepoint);
+    }
+    if (cache_path)
+      save_cache(cache_path);
+  }
+
+  sg_image_desc image_desc = {.usage = {.dynamic_update = true},
+                              .width = size,
+                              .height = size,
+                              .pixel_format = SG_PIXELFORMAT_R8};
+  texture.image = sg_make_image(image_desc);
+  texture.view = sg_alloc_view();
+  sg_init_view(texture.view, {.texture = {.image = texture.image}});
+  atlas_dirty = true;
+}
+
+auto TextCache::bake_glyph(uint32_t codepoint, SdfGlyph &glyph) -> bool {
+  int advance, left_bearing;
+  stbtt_GetCodepointHMetrics(&font, codepoint, &advance, &left_bearing);
+  glyph = {.advance = advance * scale};
+
+  int w = 0, h = 0, x_offset = 0, y_offset = 0;
+  uint8_t *sdf = stbtt_GetCodepointSDF(
+      &font, scale, codepoint, SDF_PADDING, SDF_EDGE,
+      (float)SDF_EDGE / SDF_PADDING, &w, &h, &x_offset, &y_offset);
+
+  // Whitespace has no bitmap, only an advance
+  if (!sdf)
+    return true;
+
+  int x, y;
+  // One extra pixel keeps neighbours out of the filter footprint
+  if (!packer.pack(w + 1, h + 1, x, y)) {
+    stbtt_FreeSDF(sdf, nullptr);
+    spdlog::error("text: SDF atlas is full, dropping U+{:04X}", codepoint);
+    return false;
+  }
+
+  for (int row = 0; row < h; row++) {
+    std::memcpy(pixels.data() + (size_t)(y + row) * atlas_size + x,
+                sdf + (size_t)row * w, w);
+  }
+  stbtt_FreeSDF(sdf, nullptr);
+
+  float inv = 1.0f / atlas_size;
+  glyph.x = x;
+  glyph.y = y;
+  glyph.width = w;
+  glyph.height = h;
+  glyph.x_offset = x_offset;
+  glyph.y_offset = y_offset;
+  // Bottom left corner first, see TextGlyph
+  glyph.uv[0] = pack_uv(x * inv);
+  glyph.uv[1] = pack_uv((y + h) * inv);
+  glyph.uv[2] = pack_uv((x + w) * inv);
+  glyph.uv[3] = pack_uv(y * inv);
+  atlas_dirty = true;
+  return true;
+}
+
+auto TextCache::get_glyph(uint32_t codepoint) -> const SdfGlyph * {
+  auto it = glyphs.find(codepoint);
+  if (it != glyphs.end())
+    return &it->second;
+
+  SdfGlyph glyph;
+  if (!bake_glyph(codepoint, glyph))
+    return nullptr;
+  return &glyphs.emplace(codepoint, glyph).first->second;
+}
+
+void TextCache::layout(const std::string &text, TextRun &run) {
+  run.glyphs.clear();
+  run.min = glm::vec2(0.0f);
+  run.max = glm::vec2(0.0f);
+
+  // In a bottom-up system, the descender sits on the origin so that the text
+  // grows upwards from it.
+  float baseline = -descent;
+  float pen = 0.0f;
+  uint32_t previous = 0;
+  for (size_t i = 0; i < text.size();) {
+    uint32_t codepoint = decode_utf8(text, i);
+    if (previous)
+      pen += scale * stbtt_GetCodepointKernAdvance(&font, previous, codepoint);
+    previous = codepoint;
+
+    auto glyph = get_glyph(codepoint);
+    if (!glyph)
+      continue;
+
+    if (glyph->width > 0) {
+      glm::vec2 size = {(float)glyph->width, (float)glyph->height};
+      glm::vec2 top_left = {pen + glyph->x_offset, baseline - glyph->y_offset};
+      run.glyphs.push_back({
+          .center = {top_left.x + size.x * 0.5f, top_left.y - size.y * 0.5f},
+          .size = size,
+          .uv = {glyph->uv[0], glyph->uv[1], glyph->uv[2], glyph->uv[3]},
+      });
+      glm::vec2 bottom_left = {top_left.x, top_left.y - size.y};
+      glm::vec2 top_right = {top_left.x + size.x, top_left.y};
+      run.min = run.glyphs.size() == 1 ? bottom_left
+                                       : glm::min(run.min, bottom_left);
+      run.max = run.glyphs.size() == 1 ? top_right
+                                       : glm::max(run.max, top_right);
+    }
+    pen += glyph->advance;
+  }
+}
+
+auto TextCache::get_run(const std::string &text) -> const TextRun * {
+  if (!valid)
+    return nullptr;
+
+  auto it = runs.find(text);
+  if (it == runs.end()) {
+    it = runs.emplace(text, TextRun{}).first;
+    layout(text, it->second);
+  }
+
+  it->second.last_used_frame = frame;
+  return &it->second;
+}
+
+void TextCache::upload() {
+  if (!atlas_dirty)
+    return;
+
+  sg_image_data data = {};
+  data.mip_levels[0] = {.ptr = pixels.data(), .size = pixels.size()};
+  sg_update_image(texture.image, data);
+  atlas_dirty = false;
+}
+
+void TextCache::end_frame() {
+  frame++;
+  if (frame % 60 != 0)
+    return;
+
+  std::erase_if(runs, [this](const auto &entry) {
+    return frame - entry.second.last_used_frame > EVICT_AFTER_FRAMES;
+  });
+}
+
+// FNV-1a over the font file and the bake settings
+auto TextCache::font_hash() const -> uint64_t {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  auto mix = [&hash](const void *data, size_t size) {
+    auto bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+  };
+  mix(font_file.data().data(), font_file.data().size());
+  float reference_size = REFERENCE_SIZE;
+  int padding = SDF_PADDING;
+  mix(&reference_size, sizeof(reference_size));
+  mix(&padding, sizeof(padding));
+  mix(&atlas_size, sizeof(atlas_size));
+  return hash;
+}
+
+// Layout: version, font hash, glyph count, (codepoint, SdfGlyph) pairs, then
+// the atlas pixels.
+auto TextCache::load_cache(const char *path) -> bool {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+
+  uint32_t version = 0;
+  uint64_t hash = 0;
+  uint32_t count = 0;
+  bool ok = fread(&version, sizeof(version), 1, f) == 1 &&
+            version == CACHE_VERSION &&
+            fread(&hash, sizeof(hash), 1, f) == 1 && hash == font_hash() &&
+            fread(&count, sizeof(count), 1, f) == 1;
+
+  std::unordered_map<uint32_t, SdfGlyph> loaded;
+  int used_height = 0;
+  for (uint32_t i = 0; ok && i < count; i++) {
+    uint32_t codepoint;
+    SdfGlyph glyph;
+    ok = fread(&codepoint, sizeof(codepoint), 1, f) == 1 &&
+         fread(&glyph, sizeof(glyph), 1, f) == 1;
+    if (!ok)
+      break;
+    loaded[codepoint] = glyph;
+    used_height = std::max(used_height, glyph.y + glyph.height + 1);
+  }
+  ok = ok && fread(pixels.data(), 1, pixels.size(), f) == pixels.size();
+  fclose(f);
+
+  if (!ok) {
+    spdlog::warn("text: ignoring stale SDF cache {}", path);
+    std::fill(pixels.begin(), pixels.end(), 0);
+    return false;
+  }
+
+  // Glyphs baked later go below the cached ones
+  glyphs = std::move(loaded);
+  int x, y;
+  if (used_height > 0)
+    packer.pack(atlas_size, used_height, x, y);
+  spdlog::info("text: loaded {} glyphs from {}", glyphs.size(), path);
+  return true;
+}
+
+void TextCache::save_cache(const char *path) const {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    spdlog::warn("text: could not write SDF cache {}", path);
+    return;
+  }
+
+  uint32_t version = CACHE_VERSION;
+  uint64_t hash = font_hash();
+  uint32_t count = (uint32_t)glyphs.size();
+  fwrite(&version, sizeof(version), 1, f);
+  fwrite(&hash, sizeof(hash), 1, f);
+  fwrite(&count, sizeof(count), 1, f);
+  for (auto &[codepoint, glyph] : glyphs) {
+    fwrite(&codepoint, sizeof(codepoint), 1, f);
+    fwrite(&glyph, sizeof(glyph), 1, f);
+  }
+  fwrite(pixels.data(), 1, pixels.size(), f);
+  fclose(f);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "atlas.hpp"
+#include "glm/glm.hpp"
+#include "sokol_gfx.h"
+#include "stb_truetype.h"
+#include "vfs.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A laid out glyph, relative to the text origin in reference pixels with y up.
+struct TextGlyph {
+  glm::vec2 center;
+  glm::vec2 size;
+  uint16_t uv[4];
+};
+
+struct TextRun {
+  std::vector<TextGlyph> glyphs;
+  // Bounds of the glyph quads, in the same space as the glyphs
+  glm::vec2 min;
+  glm::vec2 max;
+  uint64_t last_used_frame;
+};
+
+// Lays out text with stb_truetype and keeps the glyph runs, so unchanged labels
+// skip layout. Glyphs are baked once as signed distance fields at
+// REFERENCE_SIZE into a single channel atlas, and the text2 shader scales them,
+// so zooming never rasterizes or uploads anything.
+class TextCache {
+private:
+  struct SdfGlyph {
+    int x, y, width, height; // rect in the atlas
+    int x_offset, y_offset;  // bitmap offset from the pen, y down
+    float advance;
+    uint16_t uv[4];
+  };
+
+  static constexpr float REFERENCE_SIZE = 48.0f;
+  // Distance range in atlas pixels on each side of the outline
+  static constexpr int SDF_PADDING = 6;
+  static constexpr uint8_t SDF_EDGE = 128;
+  static constexpr uint32_t CACHE_VERSION = 1;
+
+  // Runs not drawn for this many frames are dropped
+  static constexpr uint64_t EVICT_AFTER_FRAMES = 300;
+
+  VfsFile font_file;
+  stbtt_fontinfo font = {};
+  bool valid = false;
+  float scale = 0.0f;   // font units to reference pixels
+  float descent = 0.0f; // reference pixels, negative
+
+  std::unordered_map<uint32_t, SdfGlyph> glyphs;
+  SkylinePacker packer;
+  int atlas_size = 0;
+  std::vector<uint8_t> pixels;
+  GpuTexture texture = {};
+  bool atlas_dirty = false;
+
+  std::unordered_map<std::string, TextRun> runs;
+  uint64_t frame = 0;
+
+  auto get_glyph(uint32_t codepoint) -> const SdfGlyph *;
+  auto bake_glyph(uint32_t codepoint, SdfGlyph &glyph) -> bool;
+  void layout(const std::string &text, TextRun &run);
+  auto font_hash() const -> uint64_t;
+  auto load_cache(const char *path) -> bool;
+  void save_cache(const char *path) const;
+
+public:
+  // Takes the font file over and bakes printable ASCII up front. With a
+  // `cache_path` the baked atlas is read from there when it matches the font,
+  // and written otherwise.
+  void init(VfsFile font, int atlas_size, const char *cache_path = nullptr);
+
+  auto is_valid() const -> bool { return valid; }
+
+  // Returns the cached run, laying it out on a miss. Glyph sizes are in
+  // reference pixels; scale by get_scale(size) to draw at `size`. Returns
+  // nullptr if no font is loaded.
+  auto get_run(const std::string &text) -> const TextRun *;
+
+  auto get_scale(float size) const -> float { return size / REFERENCE_SIZE; }
+
+  // Uploads the atlas if glyphs were baked since the last upload.
+  void upload();
+
+  // Evicts runs that have not been used for a while.
+  void end_frame();
+
+  auto get_texture() const -> const GpuTexture & { return texture; }
+};
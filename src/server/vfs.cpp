@@ -0,0 +1,78 @@
+#include "vfs.hpp"
+#include "spdlog/spdlog.h"
+#include <cstring>
+#include <filesystem>
+
+VfsFile::VfsFile(std::unique_ptr<MappedFile> file) : mapping(std::move(file)) {
+  bytes = {(const std::byte *)mapping->data(), mapping->size()};
+}
+
+auto Vfs::normalize(std::string_view path) -> std::string {
+  std::string name(path);
+  for (auto &c : name) {
+    if (c == '\\')
+      c = '/';
+  }
+  while (name.starts_with("./")) {
+    name.erase(0, 2);
+  }
+  return name;
+}
+
+auto Vfs::mount(const char *pack_path) -> bool {
+  if (!pack.open(pack_path))
+    return false;
+
+  auto base = pack.data();
+  auto size = pack.size();
+  auto header = (const PackHeader *)base;
+  bool valid = size >= sizeof(PackHeader) &&
+               std::memcmp(header->magic, "LXPK", 4) == 0 &&
+               header->version == PACK_VERSION &&
+               header->toc_offset + header->entry_count * sizeof(PackEntry) <=
+                   size;
+  if (!valid) {
+    spdlog::error("vfs: {} is not a valid pack", pack_path);
+    pack.close();
+    return false;
+  }
+
+  auto toc = (const PackEntry *)(base + header->toc_offset);
+  for (uint64_t i = 0; i < header->entry_count; i++) {
+    auto &entry = toc[i];
+    if (entry.offset + entry.size > size ||
+        entry.name_offset + entry.name_length > size) {
+      spdlog::error("vfs: corrupt entry {} in {}", i, pack_path);
+      continue;
+    }
+
+    std::string_view name((const char *)base + entry.name_offset,
+                          entry.name_length);
+    entries[name] = {(const std::byte *)base + entry.offset, entry.size};
+  }
+
+  spdlog::info("vfs: mounted {} ({} files, {} bytes)", pack_path,
+               entries.size(), size);
+  return true;
+}
+
+auto Vfs::open(std::string_view path) const -> VfsFile {
+  auto name = normalize(path);
+  auto it = entries.find(name);
+  if (it != entries.end())
+    return VfsFile(it->second);
+
+  auto file = std::make_unique<MappedFile>();
+  if (!file->open(name.c_str()))
+    return {};
+  return VfsFile(std::move(file));
+}
+
+auto Vfs::exists(std::string_view path) const -> bool {
+  auto name = normalize(path);
+  if (entries.contains(name))
+    return true;
+
+  std::error_code error;
+  return std::filesystem::is_regular_file(name, error);
+}
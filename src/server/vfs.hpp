@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Pack file layout, written by the pack tool:
+//
+//   PackHeader
+//   file data, each entry 16-byte aligned, sorted by name
+//   PackEntry[entry_count] at toc_offset
+//   names, referenced by PackEntry::name_offset
+struct PackHeader {
+  char magic[4]; // "LXPK"
+  uint32_t version;
+  uint64_t entry_count;
+  uint64_t toc_offset;
+};
+
+struct PackEntry {
+  uint64_t offset;
+  uint64_t size;
+  uint64_t name_offset;
+  uint64_t name_length;
+};
+
+static constexpr uint32_t PACK_VERSION = 1;
+
+// Read-only bytes of a file. Views into the pack share its mapping; loose
+// files keep their own mapping alive for as long as the VfsFile lives.
+class VfsFile {
+private:
+  std::span<const std::byte> bytes;
+  std::unique_ptr<MappedFile> mapping;
+
+public:
+  VfsFile() = default;
+  explicit VfsFile(std::span<const std::byte> bytes) : bytes(bytes) {}
+  explicit VfsFile(std::unique_ptr<MappedFile> mapping);
+
+  auto data() const -> std::span<const std::byte> { return bytes; }
+  auto is_valid() const -> bool { return bytes.data() != nullptr; }
+};
+
+// Looks paths up in the mounted pack, falling back to loose files on disk so
+// development works without packing. Lookups are safe from any thread once
+// the pack is mounted.
+class Vfs {
+private:
+  MappedFile pack;
+  std::unordered_map<std::string_view, std::span<const std::byte>> entries;
+
+public:
+  // Maps the pack and reads its table of contents. Returns false if the file
+  // is missing or invalid, leaving only loose files.
+  auto mount(const char *pack_path) -> bool;
+
+  // Returns an invalid file if `path` exists neither in the pack nor on disk.
+  auto open(std::string_view path) const -> VfsFile;
+
+  auto exists(std::string_view path) const -> bool;
+
+  // Strips "./" and turns backslashes into slashes, as names are stored.
+  static auto normalize(std::string_view path) -> std::string;
+};
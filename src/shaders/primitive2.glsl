@@ -0,0 +1,88 @@
+@vs primitive2_vs
+layout(binding=0) uniform primitive2_params {
+    mat4 mvp;
+    // x: size of a screen pixel in world units
+    vec4 misc;
+};
+
+// Shared unit quad, corners in [-0.5, 0.5]
+in vec2 corner;
+
+// Per instance: p0 in xy and p1 in zw, then (radius, outline half width,
+// kind) and color. Kinds: 0 segment, 1 box, 2 disc, 3 ring.
+in vec4 inst_points;
+in vec4 inst_params;
+in vec4 inst_color;
+
+out vec2 local;
+out vec4 shape;
+out vec4 color;
+out float aa_width;
+
+void main() {
+    float aa = misc.x;
+    float radius = inst_params.x;
+    float outline = inst_params.y;
+    float kind = inst_params.z;
+
+    vec2 center;
+    vec2 axis;
+    vec2 extent;
+    float half_length;
+    if (kind < 1.5) {
+        vec2 d = inst_points.zw - inst_points.xy;
+        half_length = length(d) * 0.5;
+        axis = half_length > 0.0 ? d / (half_length * 2.0) : vec2(1.0, 0.0);
+        center = (inst_points.xy + inst_points.zw) * 0.5;
+        float cap = kind < 0.5 ? radius : 0.0;
+        extent = vec2(half_length + cap, radius) + aa;
+    } else {
+        half_length = 0.0;
+        axis = vec2(1.0, 0.0);
+        center = inst_points.xy;
+        extent = vec2(radius + outline + aa);
+    }
+
+    vec2 normal = vec2(-axis.y, axis.x);
+    local = corner * 2.0 * extent;
+    vec2 world = center + axis * local.x + normal * local.y;
+    gl_Position = mvp * vec4(world, 0.0, 1.0);
+    shape = vec4(half_length, radius, outline, kind);
+    color = inst_color;
+    aa_width = aa;
+}
+@end
+
+@fs primitive2_fs
+in vec2 local;
+in vec4 shape;
+in vec4 color;
+in float aa_width;
+
+out vec4 frag_color;
+
+void main() {
+    float half_length = shape.x;
+    float radius = shape.y;
+    float outline = shape.z;
+    float kind = shape.w;
+
+    float d;
+    if (kind < 0.5) {
+        vec2 q = vec2(max(abs(local.x) - half_length, 0.0), local.y);
+        d = length(q) - radius;
+    } else if (kind < 1.5) {
+        vec2 q = abs(local) - vec2(half_length, radius);
+        d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+    } else if (kind < 2.5) {
+        d = length(local) - radius;
+    } else {
+        d = abs(length(local) - radius) - outline;
+    }
+
+    float coverage = clamp(0.5 - d / aa_width, 0.0, 1.0);
+    frag_color = vec4(color.rgb, color.a * coverage);
+}
+@end
+
+@program primitive2 primitive2_vs primitive2_fs
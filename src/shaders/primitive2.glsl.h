@@ -0,0 +1,310 @@
+#pragma once
+/*
+    #version:1# (machine generated, don't edit!)
+
+    Generated by sokol-shdc (https://github.com/floooh/sokol-tools)
+
+    Cmdline:
+        sokol-shdc -i src/shaders/primitive2.glsl -o src/shaders/primitive2.glsl.h -l glsl430 -f sokol
+
+    Overview:
+    =========
+    Shader program: 'primitive2':
+        Get shader desc: primitive2_shader_desc(sg_query_backend());
+        Vertex Shader: primitive2_vs
+        Fragment Shader: primitive2_fs
+        Attributes:
+            ATTR_primitive2_corner => 0
+            ATTR_primitive2_inst_points => 1
+            ATTR_primitive2_inst_params => 2
+            ATTR_primitive2_inst_color => 3
+    Bindings:
+        Uniform block 'primitive2_params':
+            C struct: primitive2_params_t
+            Bind slot: UB_primitive2_params => 0
+*/
+#if !defined(SOKOL_GFX_INCLUDED)
+#error "Please include sokol_gfx.h before primitive2.glsl.h"
+#endif
+#if !defined(SOKOL_SHDC_ALIGN)
+#if defined(_MSC_VER)
+#define SOKOL_SHDC_ALIGN(a) __declspec(align(a))
+#else
+#define SOKOL_SHDC_ALIGN(a) __attribute__((aligned(a)))
+#endif
+#endif
+#define ATTR_primitive2_corner (0)
+#define ATTR_primitive2_inst_points (1)
+#define ATTR_primitive2_inst_params (2)
+#define ATTR_primitive2_inst_color (3)
+#define UB_primitive2_params (0)
+#pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct primitive2_params_t {
+    float mvp[16];
+    float misc[4];
+} primitive2_params_t;
+#pragma pack(pop)
+/*
+    #version 430
+
+    uniform vec4 primitive2_params[5];
+    layout(location = 2) in vec4 inst_params;
+    layout(location = 1) in vec4 inst_points;
+    layout(location = 0) in vec2 corner;
+    layout(location = 0) out vec2 local;
+    layout(location = 1) out vec4 shape;
+    layout(location = 2) out vec4 color;
+    layout(location = 3) in vec4 inst_color;
+    layout(location = 3) out float aa_width;
+
+    void main()
+    {
+        float radius = inst_params.x;
+        float outline = inst_params.y;
+        float kind = inst_params.z;
+        vec2 center;
+        vec2 axis;
+        vec2 extent;
+        float half_length;
+        if (kind < 1.5)
+        {
+            vec2 d = inst_points.zw - inst_points.xy;
+            half_length = length(d) * 0.5;
+            axis = (half_length > 0.0) ? (d / vec2(half_length * 2.0)) : vec2(1.0, 0.0);
+            center = (inst_points.xy + inst_points.zw) * 0.5;
+            extent = vec2(half_length + ((kind < 0.5) ? radius : 0.0), radius) + vec2(primitive2_params[4].x);
+        }
+        else
+        {
+            half_length = 0.0;
+            axis = vec2(1.0, 0.0);
+            center = inst_points.xy;
+            extent = vec2((radius + outline) + primitive2_params[4].x);
+        }
+        local = (corner * 2.0) * extent;
+        gl_Position = mat4(primitive2_params[0], primitive2_params[1], primitive2_params[2], primitive2_params[3]) * vec4((center + (axis * local.x)) + (vec2(-axis.y, axis.x) * local.y), 0.0, 1.0);
+        shape = vec4(half_length, radius, outline, kind);
+        color = inst_color;
+        aa_width = primitive2_params[4].x;
+    }
+
+*/
+static const uint8_t primitive2_vs_source_glsl430[1454] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x33,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x70,0x72,0x69,0x6d,0x69,
+    0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x35,0x5d,0x3b,
+    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
+    0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,
+    0x73,0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
+    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,
+    0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,
+    0x6e,0x74,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,
+    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,
+    0x32,0x20,0x63,0x6f,0x72,0x6e,0x65,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
+    0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,
+    0x75,0x74,0x20,0x76,0x65,0x63,0x32,0x20,0x6c,0x6f,0x63,0x61,0x6c,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x31,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x73,0x68,0x61,
+    0x70,0x65,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,
+    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,
+    0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,
+    0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,
+    0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,0x5f,0x63,0x6f,0x6c,0x6f,0x72,
+    0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,
+    0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x6f,0x75,0x74,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x20,0x61,0x61,0x5f,0x77,0x69,0x64,0x74,0x68,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,
+    0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,
+    0x6f,0x61,0x74,0x20,0x72,0x61,0x64,0x69,0x75,0x73,0x20,0x3d,0x20,0x69,0x6e,0x73,
+    0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x2e,0x78,0x3b,0x0a,0x20,0x20,0x20,0x20,
+    0x66,0x6c,0x6f,0x61,0x74,0x20,0x6f,0x75,0x74,0x6c,0x69,0x6e,0x65,0x20,0x3d,0x20,
+    0x69,0x6e,0x73,0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x2e,0x79,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x6b,0x69,0x6e,0x64,0x20,0x3d,0x20,
+    0x69,0x6e,0x73,0x74,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x2e,0x7a,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x63,0x65,0x6e,0x74,0x65,0x72,0x3b,0x0a,
+    0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x78,0x69,0x73,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x65,0x78,0x74,0x65,0x6e,0x74,0x3b,0x0a,
+    0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x68,0x61,0x6c,0x66,0x5f,0x6c,
+    0x65,0x6e,0x67,0x74,0x68,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x66,0x20,0x28,0x6b,
+    0x69,0x6e,0x64,0x20,0x3c,0x20,0x31,0x2e,0x35,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,
+    0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x64,0x20,
+    0x3d,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,0x6e,0x74,0x73,0x2e,0x7a,0x77,
+    0x20,0x2d,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,0x6e,0x74,0x73,0x2e,0x78,
+    0x79,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x68,0x61,0x6c,0x66,0x5f,
+    0x6c,0x65,0x6e,0x67,0x74,0x68,0x20,0x3d,0x20,0x6c,0x65,0x6e,0x67,0x74,0x68,0x28,
+    0x64,0x29,0x20,0x2a,0x20,0x30,0x2e,0x35,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x61,0x78,0x69,0x73,0x20,0x3d,0x20,0x28,0x68,0x61,0x6c,0x66,0x5f,0x6c,
+    0x65,0x6e,0x67,0x74,0x68,0x20,0x3e,0x20,0x30,0x2e,0x30,0x29,0x20,0x3f,0x20,0x28,
+    0x64,0x20,0x2f,0x20,0x76,0x65,0x63,0x32,0x28,0x68,0x61,0x6c,0x66,0x5f,0x6c,0x65,
+    0x6e,0x67,0x74,0x68,0x20,0x2a,0x20,0x32,0x2e,0x30,0x29,0x29,0x20,0x3a,0x20,0x76,
+    0x65,0x63,0x32,0x28,0x31,0x2e,0x30,0x2c,0x20,0x30,0x2e,0x30,0x29,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x65,0x6e,0x74,0x65,0x72,0x20,0x3d,0x20,
+    0x28,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,0x6e,0x74,0x73,0x2e,0x78,0x79,0x20,
+    0x2b,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,0x6e,0x74,0x73,0x2e,0x7a,0x77,
+    0x29,0x20,0x2a,0x20,0x30,0x2e,0x35,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x65,0x78,0x74,0x65,0x6e,0x74,0x20,0x3d,0x20,0x76,0x65,0x63,0x32,0x28,0x68,
+    0x61,0x6c,0x66,0x5f,0x6c,0x65,0x6e,0x67,0x74,0x68,0x20,0x2b,0x20,0x28,0x28,0x6b,
+    0x69,0x6e,0x64,0x20,0x3c,0x20,0x30,0x2e,0x35,0x29,0x20,0x3f,0x20,0x72,0x61,0x64,
+    0x69,0x75,0x73,0x20,0x3a,0x20,0x30,0x2e,0x30,0x29,0x2c,0x20,0x72,0x61,0x64,0x69,
+    0x75,0x73,0x29,0x20,0x2b,0x20,0x76,0x65,0x63,0x32,0x28,0x70,0x72,0x69,0x6d,0x69,
+    0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2e,
+    0x78,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x65,0x6c,
+    0x73,0x65,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x68,0x61,0x6c,0x66,0x5f,0x6c,0x65,0x6e,0x67,0x74,0x68,0x20,0x3d,0x20,0x30,
+    0x2e,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x78,0x69,0x73,
+    0x20,0x3d,0x20,0x76,0x65,0x63,0x32,0x28,0x31,0x2e,0x30,0x2c,0x20,0x30,0x2e,0x30,
+    0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x65,0x6e,0x74,0x65,
+    0x72,0x20,0x3d,0x20,0x69,0x6e,0x73,0x74,0x5f,0x70,0x6f,0x69,0x6e,0x74,0x73,0x2e,
+    0x78,0x79,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x65,0x78,0x74,0x65,
+    0x6e,0x74,0x20,0x3d,0x20,0x76,0x65,0x63,0x32,0x28,0x28,0x72,0x61,0x64,0x69,0x75,
+    0x73,0x20,0x2b,0x20,0x6f,0x75,0x74,0x6c,0x69,0x6e,0x65,0x29,0x20,0x2b,0x20,0x70,
+    0x72,0x69,0x6d,0x69,0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
+    0x5b,0x34,0x5d,0x2e,0x78,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,
+    0x20,0x20,0x6c,0x6f,0x63,0x61,0x6c,0x20,0x3d,0x20,0x28,0x63,0x6f,0x72,0x6e,0x65,
+    0x72,0x20,0x2a,0x20,0x32,0x2e,0x30,0x29,0x20,0x2a,0x20,0x65,0x78,0x74,0x65,0x6e,
+    0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x70,0x72,0x69,0x6d,0x69,0x74,
+    0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,
+    0x70,0x72,0x69,0x6d,0x69,0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,
+    0x73,0x5b,0x31,0x5d,0x2c,0x20,0x70,0x72,0x69,0x6d,0x69,0x74,0x69,0x76,0x65,0x32,
+    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x70,0x72,0x69,0x6d,
+    0x69,0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,
+    0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x28,0x63,0x65,0x6e,0x74,0x65,0x72,
+    0x20,0x2b,0x20,0x28,0x61,0x78,0x69,0x73,0x20,0x2a,0x20,0x6c,0x6f,0x63,0x61,0x6c,
+    0x2e,0x78,0x29,0x29,0x20,0x2b,0x20,0x28,0x76,0x65,0x63,0x32,0x28,0x2d,0x61,0x78,
+    0x69,0x73,0x2e,0x79,0x2c,0x20,0x61,0x78,0x69,0x73,0x2e,0x78,0x29,0x20,0x2a,0x20,
+    0x6c,0x6f,0x63,0x61,0x6c,0x2e,0x79,0x29,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,
+    0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x68,0x61,0x70,0x65,0x20,0x3d,
+    0x20,0x76,0x65,0x63,0x34,0x28,0x68,0x61,0x6c,0x66,0x5f,0x6c,0x65,0x6e,0x67,0x74,
+    0x68,0x2c,0x20,0x72,0x61,0x64,0x69,0x75,0x73,0x2c,0x20,0x6f,0x75,0x74,0x6c,0x69,
+    0x6e,0x65,0x2c,0x20,0x6b,0x69,0x6e,0x64,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,
+    0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x69,0x6e,0x73,0x74,0x5f,0x63,0x6f,0x6c,0x6f,
+    0x72,0x3b,0x0a,0x20,0x20,0x20,0x20,0x61,0x61,0x5f,0x77,0x69,0x64,0x74,0x68,0x20,
+    0x3d,0x20,0x70,0x72,0x69,0x6d,0x69,0x74,0x69,0x76,0x65,0x32,0x5f,0x70,0x61,0x72,
+    0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2e,0x78,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+};
+/*
+    #version 430
+
+    layout(location = 1) in vec4 shape;
+    layout(location = 0) in vec2 local;
+    layout(location = 3) in float aa_width;
+    layout(location = 0) out vec4 frag_color;
+    layout(location = 2) in vec4 color;
+
+    void main()
+    {
+        float d;
+        if (shape.w < 0.5)
+        {
+            d = length(vec2(max(abs(local.x) - shape.x, 0.0), local.y)) - shape.y;
+        }
+        else
+        {
+            if (shape.w < 1.5)
+            {
+                vec2 q = abs(local) - vec2(shape.x, shape.y);
+                d = length(max(q, vec2(0.0))) + min(max(q.x, q.y), 0.0);
+            }
+            else
+            {
+                if (shape.w < 2.5)
+                {
+                    d = length(local) - shape.y;
+                }
+                else
+                {
+                    d = abs(length(local) - shape.y) - shape.z;
+                }
+            }
+        }
+        frag_color = vec4(color.xyz, color.w * clamp(0.5 - (d / aa_width), 0.0, 1.0));
+    }
+
+*/
+static const uint8_t primitive2_fs_source_glsl430[870] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x33,0x30,0x0a,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x73,0x68,0x61,0x70,0x65,
+    0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,
+    0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x6c,
+    0x6f,0x63,0x61,0x6c,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,
+    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,
+    0x6f,0x61,0x74,0x20,0x61,0x61,0x5f,0x77,0x69,0x64,0x74,0x68,0x3b,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x66,0x72,0x61,0x67,
+    0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,
+    0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,
+    0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,0x6f,0x69,
+    0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,
+    0x6c,0x6f,0x61,0x74,0x20,0x64,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x66,0x20,0x28,
+    0x73,0x68,0x61,0x70,0x65,0x2e,0x77,0x20,0x3c,0x20,0x30,0x2e,0x35,0x29,0x0a,0x20,
+    0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x20,0x3d,
+    0x20,0x6c,0x65,0x6e,0x67,0x74,0x68,0x28,0x76,0x65,0x63,0x32,0x28,0x6d,0x61,0x78,
+    0x28,0x61,0x62,0x73,0x28,0x6c,0x6f,0x63,0x61,0x6c,0x2e,0x78,0x29,0x20,0x2d,0x20,
+    0x73,0x68,0x61,0x70,0x65,0x2e,0x78,0x2c,0x20,0x30,0x2e,0x30,0x29,0x2c,0x20,0x6c,
+    0x6f,0x63,0x61,0x6c,0x2e,0x79,0x29,0x29,0x20,0x2d,0x20,0x73,0x68,0x61,0x70,0x65,
+    0x2e,0x79,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x65,0x6c,
+    0x73,0x65,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x69,0x66,0x20,0x28,0x73,0x68,0x61,0x70,0x65,0x2e,0x77,0x20,0x3c,0x20,0x31,
+    0x2e,0x35,0x29,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x71,
+    0x20,0x3d,0x20,0x61,0x62,0x73,0x28,0x6c,0x6f,0x63,0x61,0x6c,0x29,0x20,0x2d,0x20,
+    0x76,0x65,0x63,0x32,0x28,0x73,0x68,0x61,0x70,0x65,0x2e,0x78,0x2c,0x20,0x73,0x68,
+    0x61,0x70,0x65,0x2e,0x79,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x64,0x20,0x3d,0x20,0x6c,0x65,0x6e,0x67,0x74,0x68,0x28,0x6d,
+    0x61,0x78,0x28,0x71,0x2c,0x20,0x76,0x65,0x63,0x32,0x28,0x30,0x2e,0x30,0x29,0x29,
+    0x29,0x20,0x2b,0x20,0x6d,0x69,0x6e,0x28,0x6d,0x61,0x78,0x28,0x71,0x2e,0x78,0x2c,
+    0x20,0x71,0x2e,0x79,0x29,0x2c,0x20,0x30,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x65,
+    0x6c,0x73,0x65,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x66,0x20,0x28,0x73,0x68,
+    0x61,0x70,0x65,0x2e,0x77,0x20,0x3c,0x20,0x32,0x2e,0x35,0x29,0x0a,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x20,0x3d,0x20,0x6c,
+    0x65,0x6e,0x67,0x74,0x68,0x28,0x6c,0x6f,0x63,0x61,0x6c,0x29,0x20,0x2d,0x20,0x73,
+    0x68,0x61,0x70,0x65,0x2e,0x79,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x65,0x6c,0x73,0x65,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x64,0x20,0x3d,0x20,0x61,0x62,0x73,0x28,0x6c,0x65,0x6e,
+    0x67,0x74,0x68,0x28,0x6c,0x6f,0x63,0x61,0x6c,0x29,0x20,0x2d,0x20,0x73,0x68,0x61,
+    0x70,0x65,0x2e,0x79,0x29,0x20,0x2d,0x20,0x73,0x68,0x61,0x70,0x65,0x2e,0x7a,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,
+    0x20,0x20,0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,
+    0x76,0x65,0x63,0x34,0x28,0x63,0x6f,0x6c,0x6f,0x72,0x2e,0x78,0x79,0x7a,0x2c,0x20,
+    0x63,0x6f,0x6c,0x6f,0x72,0x2e,0x77,0x20,0x2a,0x20,0x63,0x6c,0x61,0x6d,0x70,0x28,
+    0x30,0x2e,0x35,0x20,0x2d,0x20,0x28,0x64,0x20,0x2f,0x20,0x61,0x61,0x5f,0x77,0x69,
+    0x64,0x74,0x68,0x29,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x29,
+    0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+};
+static inline const sg_shader_desc* primitive2_shader_desc(sg_backend backend) {
+    if (backend == SG_BACKEND_GLCORE) {
+        static sg_shader_desc desc;
+        static bool valid;
+        if (!valid) {
+            valid = true;
+            desc.vertex_func.source = (const char*)primitive2_vs_source_glsl430;
+            desc.vertex_func.entry = "main";
+            desc.fragment_func.source = (const char*)primitive2_fs_source_glsl430;
+            desc.fragment_func.entry = "main";
+            desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[0].glsl_name = "corner";
+            desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[1].glsl_name = "inst_points";
+            desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[2].glsl_name = "inst_params";
+            desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[3].glsl_name = "inst_color";
+            desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
+            desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
+            desc.uniform_blocks[0].size = 80;
+            desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[0].glsl_uniforms[0].array_count = 5;
+            desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "primitive2_params";
+            desc.label = "primitive2_shader";
+        }
+        return &desc;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+@vs sprite2_vs
+layout(binding=0) uniform sprite2_params {
+    mat4 mvp;
+};
+
+// Shared unit quad, corners in [-0.5, 0.5]
+in vec2 corner;
+
+// Per instance: columns of the 2x2 linear part, translation and size,
+// uv rect and tint
+in vec4 inst_basis;
+in vec4 inst_origin;
+in vec4 inst_uv;
+in vec4 inst_color;
+
+out vec2 uvs;
+out vec4 color;
+
+void main() {
+    vec2 local = corner * inst_origin.zw;
+    vec2 world = inst_basis.xy * local.x + inst_basis.zw * local.y + inst_origin.xy;
+    gl_Position = mvp * vec4(world, 0.0, 1.0);
+    uvs = mix(inst_uv.xy, inst_uv.zw, corner + 0.5);
+    color = inst_color;
+}
+@end
+
+@fs sprite2_fs
+layout(binding=0) uniform texture2D tex;
+layout(binding=0) uniform sampler smp;
+
+in vec2 uvs;
+in vec4 color;
+
+out vec4 frag_color;
+
+void main() {
+    frag_color = texture(sampler2D(tex, smp), uvs) * color;
+}
+@end
+
+@program sprite2 sprite2_vs sprite2_fs
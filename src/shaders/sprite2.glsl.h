@@ -0,0 +1,196 @@
+#pragma once
+/*
+    #version:1# (machine generated, don't edit!)
+
+    Generated by sokol-shdc (https://github.com/floooh/sokol-tools)
+
+    Cmdline:
+        sokol-shdc -i src/shaders/sprite2.glsl -o src/shaders/sprite2.glsl.h -l glsl430 -f sokol
+
+    Overview:
+    =========
+    Shader program: 'sprite2':
+        Get shader desc: sprite2_shader_desc(sg_query_backend());
+        Vertex Shader: sprite2_vs
+        Fragment Shader: sprite2_fs
+        Attributes:
+            ATTR_sprite2_corner => 0
+            ATTR_sprite2_inst_basis => 1
+            ATTR_sprite2_inst_origin => 2
+            ATTR_sprite2_inst_uv => 3
+            ATTR_sprite2_inst_color => 4
+    Bindings:
+        Uniform block 'sprite2_params':
+            C struct: sprite2_params_t
+            Bind slot: UB_sprite2_params => 0
+        Texture 'tex':
+            Image type: SG_IMAGETYPE_2D
+            Sample type: SG_IMAGESAMPLETYPE_FLOAT
+            Multisampled: false
+            Bind slot: VIEW_tex => 0
+        Sampler 'smp':
+            Type: SG_SAMPLERTYPE_FILTERING
+            Bind slot: SMP_smp => 0
+*/
+#if !defined(SOKOL_GFX_INCLUDED)
+#error "Please include sokol_gfx.h before sprite2.glsl.h"
+#endif
+#if !defined(SOKOL_SHDC_ALIGN)
+#if defined(_MSC_VER)
+#define SOKOL_SHDC_ALIGN(a) __declspec(align(a))
+#else
+#define SOKOL_SHDC_ALIGN(a) __attribute__((aligned(a)))
+#endif
+#endif
+#define ATTR_sprite2_corner (0)
+#define ATTR_sprite2_inst_basis (1)
+#define ATTR_sprite2_inst_origin (2)
+#define ATTR_sprite2_inst_uv (3)
+#define ATTR_sprite2_inst_color (4)
+#define UB_sprite2_params (0)
+#define VIEW_tex (0)
+#define SMP_smp (0)
+#pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct sprite2_params_t {
+    float mvp[16];
+} sprite2_params_t;
+#pragma pack(pop)
+/*
+    #version 430
+
+    uniform vec4 sprite2_params[4];
+    layout(location = 0) in vec2 corner;
+    layout(location = 2) in vec4 inst_origin;
+    layout(location = 1) in vec4 inst_basis;
+    layout(location = 0) out vec2 uvs;
+    layout(location = 3) in vec4 inst_uv;
+    layout(location = 1) out vec4 color;
+    layout(location = 4) in vec4 inst_color;
+
+    void main()
+    {
+        vec2 _21 = corner * inst_origin.zw;
+        gl_Position = mat4(sprite2_params[0], sprite2_params[1], sprite2_params[2], sprite2_params[3]) * vec4(((inst_basis.xy * _21.x) + (inst_basis.zw * _21.y)) + inst_origin.xy, 0.0, 1.0);
+        uvs = mix(inst_uv.xy, inst_uv.zw, corner + vec2(0.5));
+        color = inst_color;
+    }
+
+*/
+static const uint8_t sprite2_vs_source_glsl430[646] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x33,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x73,0x70,0x72,0x69,0x74,
+    0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x63,0x6f,0x72,0x6e,0x65,
+    0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,
+    0x69,0x6e,0x73,0x74,0x5f,0x6f,0x72,0x69,0x67,0x69,0x6e,0x3b,0x0a,0x6c,0x61,0x79,
+    0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,
+    0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,0x5f,0x62,
+    0x61,0x73,0x69,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,
+    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,
+    0x65,0x63,0x32,0x20,0x75,0x76,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,
+    0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,
+    0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,0x5f,0x75,0x76,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x31,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,
+    0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,
+    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x34,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,
+    0x20,0x69,0x6e,0x73,0x74,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,0x6f,
+    0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,
+    0x76,0x65,0x63,0x32,0x20,0x5f,0x32,0x31,0x20,0x3d,0x20,0x63,0x6f,0x72,0x6e,0x65,
+    0x72,0x20,0x2a,0x20,0x69,0x6e,0x73,0x74,0x5f,0x6f,0x72,0x69,0x67,0x69,0x6e,0x2e,
+    0x7a,0x77,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,
+    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x73,0x70,0x72,0x69,0x74,
+    0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x73,0x70,
+    0x72,0x69,0x74,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,
+    0x20,0x73,0x70,0x72,0x69,0x74,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
+    0x32,0x5d,0x2c,0x20,0x73,0x70,0x72,0x69,0x74,0x65,0x32,0x5f,0x70,0x61,0x72,0x61,
+    0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x28,0x28,
+    0x69,0x6e,0x73,0x74,0x5f,0x62,0x61,0x73,0x69,0x73,0x2e,0x78,0x79,0x20,0x2a,0x20,
+    0x5f,0x32,0x31,0x2e,0x78,0x29,0x20,0x2b,0x20,0x28,0x69,0x6e,0x73,0x74,0x5f,0x62,
+    0x61,0x73,0x69,0x73,0x2e,0x7a,0x77,0x20,0x2a,0x20,0x5f,0x32,0x31,0x2e,0x79,0x29,
+    0x29,0x20,0x2b,0x20,0x69,0x6e,0x73,0x74,0x5f,0x6f,0x72,0x69,0x67,0x69,0x6e,0x2e,
+    0x78,0x79,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x75,0x76,0x73,0x20,0x3d,0x20,0x6d,0x69,0x78,0x28,0x69,0x6e,0x73,
+    0x74,0x5f,0x75,0x76,0x2e,0x78,0x79,0x2c,0x20,0x69,0x6e,0x73,0x74,0x5f,0x75,0x76,
+    0x2e,0x7a,0x77,0x2c,0x20,0x63,0x6f,0x72,0x6e,0x65,0x72,0x20,0x2b,0x20,0x76,0x65,
+    0x63,0x32,0x28,0x30,0x2e,0x35,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x63,0x6f,
+    0x6c,0x6f,0x72,0x20,0x3d,0x20,0x69,0x6e,0x73,0x74,0x5f,0x63,0x6f,0x6c,0x6f,0x72,
+    0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+};
+/*
+    #version 430
+
+    layout(binding = 0) uniform sampler2D tex_smp;
+
+    layout(location = 0) out vec4 frag_color;
+    layout(location = 0) in vec2 uvs;
+    layout(location = 1) in vec4 color;
+
+    void main()
+    {
+        frag_color = texture(tex_smp, uvs) * color;
+    }
+
+*/
+static const uint8_t sprite2_fs_source_glsl430[241] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x34,0x33,0x30,0x0a,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x62,0x69,0x6e,0x64,0x69,0x6e,0x67,0x20,0x3d,0x20,0x30,
+    0x29,0x20,0x75,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,
+    0x72,0x32,0x44,0x20,0x74,0x65,0x78,0x5f,0x73,0x6d,0x70,0x3b,0x0a,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x66,0x72,0x61,0x67,
+    0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,
+    0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,
+    0x76,0x65,0x63,0x32,0x20,0x75,0x76,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
+    0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x69,
+    0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,
+    0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,
+    0x20,0x66,0x72,0x61,0x67,0x5f,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x74,0x65,
+    0x78,0x74,0x75,0x72,0x65,0x28,0x74,0x65,0x78,0x5f,0x73,0x6d,0x70,0x2c,0x20,0x75,
+    0x76,0x73,0x29,0x20,0x2a,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x7d,0x0a,0x0a,
+    0x00,
+};
+static inline const sg_shader_desc* sprite2_shader_desc(sg_backend backend) {
+    if (backend == SG_BACKEND_GLCORE) {
+        static sg_shader_desc desc;
+        static bool valid;
+        if (!valid) {
+            valid = true;
+            desc.vertex_func.source = (const char*)sprite2_vs_source_glsl430;
+            desc.vertex_func.entry = "main";
+            desc.fragment_func.source = (const char*)sprite2_fs_source_glsl430;
+            desc.fragment_func.entry = "main";
+            desc.attrs[0].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[0].glsl_name = "corner";
+            desc.attrs[1].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[1].glsl_name = "inst_basis";
+            desc.attrs[2].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[2].glsl_name = "inst_origin";
+            desc.attrs[3].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[3].glsl_name = "inst_uv";
+            desc.attrs[4].base_type = SG_SHADERATTRBASETYPE_FLOAT;
+            desc.attrs[4].glsl_name = "inst_color";
+            desc.uniform_blocks[0].stage = SG_SHADERSTAGE_VERTEX;
+            desc.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
+            desc.uniform_blocks[0].size = 64;
+            desc.uniform_blocks[0].glsl_uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+            desc.uniform_blocks[0].glsl_uniforms[0].array_count = 4;
+            desc.uniform_blocks[0].glsl_uniforms[0].glsl_name = "sprite2_params";
+            desc.views[0].texture.stage = SG_SHADERSTAGE_FRAGMENT;
+            desc.views[0].texture.image_type = SG_IMAGETYPE_2D;
+            desc.views[0].texture.sample_type = SG_IMAGESAMPLETYPE_FLOAT;
+            desc.views[0].texture.multisampled = false;
+            desc.samplers[0].stage = SG_SHADERSTAGE_FRAGMENT;
+            desc.samplers[0].sampler_type = SG_SAMPLERTYPE_FILTERING;
+            desc.texture_sampler_pairs[0].stage = SG_SHADERSTAGE_FRAGMENT;
+            desc.texture_sampler_pairs[0].view_slot = 0;
+            desc.texture_sampler_pairs[0].sampler_slot = 0;
+            desc.texture_sampler_pairs[0].glsl_name = "tex_smp";
+            desc.label = "sprite2_shader";
+        }
+        return &desc;
+    }
+    return 0;
+}
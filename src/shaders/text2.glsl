@@ -0,0 +1,44 @@
+@vs text2_vs
+layout(binding=0) uniform text2_params {
+    mat4 mvp;
+};
+
+// Same per-instance layout as sprite2
+in vec2 corner;
+in vec4 inst_basis;
+in vec4 inst_origin;
+in vec4 inst_uv;
+in vec4 inst_color;
+
+out vec2 uvs;
+out vec4 color;
+
+void main() {
+    vec2 local = corner * inst_origin.zw;
+    vec2 world = inst_basis.xy * local.x + inst_basis.zw * local.y + inst_origin.xy;
+    gl_Position = mvp * vec4(world, 0.0, 1.0);
+    uvs = mix(inst_uv.xy, inst_uv.zw, corner + 0.5);
+    color = inst_color;
+}
+@end
+
+@fs text2_fs
+layout(binding=0) uniform texture2D tex;
+layout(binding=0) uniform sampler smp;
+
+in vec2 uvs;
+in vec4 color;
+
+out vec4 frag_color;
+
+// The atlas stores a signed distance to the glyph outline, with the edge at
+// 0.5. Anti-aliasing over one screen pixel keeps edges sharp at any scale.
+void main() {
+    float dist = texture(sampler2D(tex, smp), uvs).r;
+    float width = fwidth(dist);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+    frag_color = vec4(color.rgb, color.a * alpha);
+}
+@end
+
+@program text2 text2_vs text2_fs
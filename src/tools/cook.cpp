@@ -0,0 +1,64 @@
+// Converts every PNG under the given directories (default: assets) into a
+// .ctex file next to it, so the game can map textures instead of decoding.
+#include "../server/cooked_texture.hpp"
+#include "spdlog/spdlog.h"
+#include "stb_image.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Files from an older cooker are redone even if newer than their source
+static auto is_current_version(const fs::path &path) -> bool {
+  CookedTextureHeader header = {};
+  std::ifstream in(path, std::ios::binary);
+  in.read((char *)&header, sizeof(header));
+  return in && header.version == COOKED_TEXTURE_VERSION;
+}
+
+static auto cook_file(const fs::path &source) -> bool {
+  auto target = fs::path(cooked_texture_path(source.string()));
+  std::error_code error;
+  bool up_to_date =
+      fs::exists(target) &&
+      fs::last_write_time(target, error) >= fs::last_write_time(source, error);
+  if (up_to_date && is_current_version(target))
+    return true;
+
+  int width, height, channels;
+  stbi_uc *pixels =
+      stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+  if (!pixels) {
+    spdlog::error("Could not load image {}: {}", source.string(),
+                  stbi_failure_reason());
+    return false;
+  }
+
+  bool ok = cook_texture(pixels, width, height, target.string().c_str());
+  stbi_image_free(pixels);
+  if (ok)
+    spdlog::info("cooked {} ({}x{})", target.string(), width, height);
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> roots;
+  for (int i = 1; i < argc; i++) {
+    roots.push_back(argv[i]);
+  }
+  if (roots.empty())
+    roots.push_back("assets");
+
+  int failed = 0;
+  for (auto &root : roots) {
+    for (auto &entry : fs::recursive_directory_iterator(root)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".png" &&
+          !cook_file(entry.path()))
+        failed++;
+    }
+  }
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Bundles asset files into one pack the game maps at startup.
+//
+//   pack <output> [<dir> | <name>=<file>]...
+//
+// Directories are added recursively under their relative path; a `name=file`
+// argument stores `file` as `name`. PNGs with a cooked .ctex next to them are
+// left out, since the game only reads the cooked file.
+#include "../server/cooked_texture.hpp"
+#include "../server/vfs.hpp"
+#include "spdlog/spdlog.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static auto align16(uint64_t offset) -> uint64_t {
+  return (offset + 15) & ~(uint64_t)15;
+}
+
+int main(int argc, char *argv[]) {
+  std::string output = argc > 1 ? argv[1] : "assets.pack";
+  std::vector<std::string> inputs(argv + std::min(argc, 2), argv + argc);
+  if (inputs.empty())
+    inputs.push_back("assets");
+
+  // Sorted by name so related files end up next to each other
+  std::map<std::string, fs::path> files;
+  for (auto &input : inputs) {
+    auto equals = input.find('=');
+    if (equals != std::string::npos) {
+      files[Vfs::normalize(input.substr(0, equals))] = input.substr(equals + 1);
+      continue;
+    }
+
+    for (auto &entry : fs::recursive_directory_iterator(input)) {
+      if (!entry.is_regular_file())
+        continue;
+
+      auto path = entry.path();
+      if (path.extension() == ".png" &&
+          fs::exists(cooked_texture_path(path.string())))
+        continue;
+      files[Vfs::normalize(path.generic_string())] = path;
+    }
+  }
+
+  std::vector<PackEntry> toc;
+  std::string names;
+  std::vector<char> data(sizeof(PackHeader), 0);
+  for (auto &[name, path] : files) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      spdlog::error("Could not read {}", path.string());
+      return 1;
+    }
+
+    std::vector<char> contents((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    data.resize(align16(data.size()), 0);
+    toc.push_back({.offset = data.size(),
+                   .size = contents.size(),
+                   .name_offset = names.size(),
+                   .name_length = name.size()});
+    data.insert(data.end(), contents.begin(), contents.end());
+    names += name;
+  }
+
+  data.resize(align16(data.size()), 0);
+  uint64_t toc_offset = data.size();
+  uint64_t names_offset = toc_offset + toc.size() * sizeof(PackEntry);
+  for (auto &entry : toc) {
+    entry.name_offset += names_offset;
+  }
+
+  PackHeader header = {.magic = {'L', 'X', 'P', 'K'},
+                       .version = PACK_VERSION,
+                       .entry_count = toc.size(),
+                       .toc_offset = toc_offset};
+  std::memcpy(data.data(), &header, sizeof(header));
+
+  FILE *f = fopen(output.c_str(), "wb");
+  if (!f) {
+    spdlog::error("Could not write {}", output);
+    return 1;
+  }
+  fwrite(data.data(), 1, data.size(), f);
+  fwrite(toc.data(), sizeof(PackEntry), toc.size(), f);
+  fwrite(names.data(), 1, names.size(), f);
+  fclose(f);
+
+  spdlog::info("packed {} files into {}", toc.size(), output);
+  return 0;
+}
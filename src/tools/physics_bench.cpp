@@ -0,0 +1,105 @@
+// Times Box2D steps on the engine task scheduler, for growing numbers of
+// bodies and 1..N worker threads.
+//
+//   physics_bench [max_workers] [steps]
+//
+// Bodies are circles dropped into a walled pit, like an enemy wave packed
+// around the player. Each cell is the mean step time in milliseconds.
+#include "../server/task_scheduler.hpp"
+#include "box2d/box2d.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static auto enqueue_task(b2TaskCallback *task, int item_count, int min_range,
+                         void *task_context, void *user_context) -> void * {
+  auto &tasks = *(TaskScheduler *)user_context;
+  return tasks.submit(task, item_count, min_range, task_context);
+}
+
+static void finish_task(void *user_task, void *user_context) {
+  auto &tasks = *(TaskScheduler *)user_context;
+  tasks.wait((TaskScheduler::Task *)user_task);
+}
+
+static auto time_steps(TaskScheduler &tasks, int body_count, int steps)
+    -> double {
+  b2WorldDef world_def = b2DefaultWorldDef();
+  world_def.workerCount = tasks.get_worker_count();
+  world_def.enqueueTask = enqueue_task;
+  world_def.finishTask = finish_task;
+  world_def.userTaskContext = &tasks;
+  auto world = b2CreateWorld(&world_def);
+
+  // Pit wide enough to fit the wave in a few dozen rows
+  float width = std::max(20.0f, (float)body_count / 40.0f);
+  b2BodyDef ground_def = b2DefaultBodyDef();
+  auto ground = b2CreateBody(world, &ground_def);
+  b2ShapeDef wall_def = b2DefaultShapeDef();
+  auto rot = b2Rot_identity;
+  b2Polygon floor = b2MakeOffsetBox(width, 1.0f, {0.0f, -1.0f}, rot);
+  b2Polygon left = b2MakeOffsetBox(1.0f, 200.0f, {-width, 0.0f}, rot);
+  b2Polygon right = b2MakeOffsetBox(1.0f, 200.0f, {width, 0.0f}, rot);
+  b2CreatePolygonShape(ground, &wall_def, &floor);
+  b2CreatePolygonShape(ground, &wall_def, &left);
+  b2CreatePolygonShape(ground, &wall_def, &right);
+
+  b2Circle circle = {.center = {0.0f, 0.0f}, .radius = 0.4f};
+  b2ShapeDef circle_def = b2DefaultShapeDef();
+  circle_def.material.restitution = 0.5f;
+  auto per_row = (int)(width * 2.0f) - 2;
+  for (int i = 0; i < body_count; i++) {
+    b2BodyDef body_def = b2DefaultBodyDef();
+    body_def.type = b2_dynamicBody;
+    body_def.position = {-width + 1.5f + (float)(i % per_row),
+                         1.0f + (float)(i / per_row)};
+    auto body = b2CreateBody(world, &body_def);
+    b2CreateCircleShape(body, &circle_def, &circle);
+  }
+
+  // Let the pile settle into contact before timing
+  const float dt = 1.0f / 60.0f;
+  for (int i = 0; i < 60; i++) {
+    b2World_Step(world, dt, 4);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < steps; i++) {
+    b2World_Step(world, dt, 4);
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  b2DestroyWorld(world);
+  return elapsed.count() / steps;
+}
+
+int main(int argc, char *argv[]) {
+  int max_workers = argc > 1 ? std::atoi(argv[1])
+                             : (int)std::thread::hardware_concurrency();
+  int steps = argc > 2 ? std::atoi(argv[2]) : 120;
+  max_workers = std::clamp(max_workers, 1, 64);
+  steps = std::max(steps, 1);
+
+  const int body_counts[] = {250, 500, 1000, 2000, 4000, 8000};
+
+  std::printf("%8s", "bodies");
+  for (int workers = 1; workers <= max_workers; workers++) {
+    std::printf("%8d", workers);
+  }
+  std::printf("\n");
+
+  for (auto body_count : body_counts) {
+    std::printf("%8d", body_count);
+    for (int workers = 1; workers <= max_workers; workers++) {
+      TaskScheduler tasks;
+      tasks.init(workers);
+      std::printf("%8.2f", time_steps(tasks, body_count, steps));
+      std::fflush(stdout);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
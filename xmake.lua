@@ -16,6 +16,7 @@ add_rules("sokol.shdc")
 set_languages("cxx20")
 add_files("src/*.cpp")
 add_files("src/server/*.cpp")
+add_files("src/math/*.cpp")
 add_files("src/game/*.cpp")
 add_files("src/modules/*.cpp")
 add_files("src/shaders/*.glsl")
@@ -55,6 +56,29 @@ after_build(function(target)
 	os.runv("ln", { "-s", assetsdir, linkpath })
 end)
 
+-- Offline texture cooker: `xmake run cook` writes a .ctex next to every png
+target("cook")
+set_kind("binary")
+set_languages("cxx20")
+add_files("src/tools/cook.cpp")
+add_files("src/stb_image.cpp")
+add_files("src/server/cooked_texture.cpp")
+add_files("src/server/mapped_file.cpp")
+add_files("src/server/vfs.cpp")
+add_packages("stb", "spdlog")
+set_rundir("$(projectdir)")
+
+-- Asset packer: `xmake run pack assets.pack assets assets/fonts/default.ttf=<ttf>`
+target("pack")
+set_kind("binary")
+set_languages("cxx20")
+add_files("src/tools/pack.cpp")
+add_files("src/server/cooked_texture.cpp")
+add_files("src/server/mapped_file.cpp")
+add_files("src/server/vfs.cpp")
+add_packages("spdlog")
+set_rundir("$(projectdir)")
+
 rule("sokol.shdc")
 set_extensions(".glsl")
 on_build_file(function(target, sourcefile, opt)
@@ -81,3 +105,14 @@ on_build_file(function(target, sourcefile, opt)
 		})
 	end, { files = sourcefile })
 end)
+
+-- Physics benchmark: `xmake run physics_bench [max_workers] [steps]`
+target("physics_bench")
+set_kind("binary")
+set_languages("cxx20")
+add_files("src/tools/physics_bench.cpp")
+add_files("src/server/task_scheduler.cpp")
+add_packages("box2d")
+if is_plat("linux") then
+	add_syslinks("pthread")
+end